@@ -0,0 +1,351 @@
+// Benchmarks for params.h: argparse, the per value setters and argdetails() on generated workloads.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -I. bench/params_bench.cpp -o params_bench -pthread
+//   ./params_bench                 // all workloads, lists up to 10^6 values
+//   ./params_bench --scale 7       // lists up to 10^7 values (needs a few GB of memory)
+//   ./params_bench --filter list   // only workloads whose name contains "list"
+//
+// Every workload builds its argv (or file) once, then repeats the measured step until it has run
+// for --seconds, and reports the best time of one repetition. Compare the output of two builds
+// to see the effect of an engine change.
+
+#include "params.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace Params;
+
+namespace {
+	struct Settings {
+		int scale = 6; // largest list is 10^scale values
+		double seconds = 0.3; // minimum measuring time per workload
+		string filter;
+	};
+
+	// argv storage for a generated command line
+	class Argv {
+		private:
+			vector<string> words;
+			vector<char*> pointers;
+		public:
+			Argv() { words.push_back("params_bench"); }
+			void add(string word) { words.push_back(move(word)); }
+			char** get() {
+				pointers.clear();
+				for (string& word : words) {
+					pointers.push_back(&word[0]);
+				}
+				pointers.push_back(nullptr);
+				return pointers.data();
+			}
+			size_t bytes() const {
+				size_t total = 0;
+				for (const string& word : words) {
+					total += word.size()+1;
+				}
+				return total;
+			}
+			size_t size() const { return words.size()-1; }
+	};
+
+	void report(const Settings& settings, const string& name, size_t tokens, size_t bytes, const function<void()>& step) {
+		if (!settings.filter.empty() && name.find(settings.filter) == string::npos)
+			return;
+		double best = 1e100, total = 0;
+		size_t repetitions = 0;
+		while (total < settings.seconds || repetitions < 3) {
+			auto started = chrono::steady_clock::now();
+			step();
+			double elapsed = chrono::duration<double>(chrono::steady_clock::now()-started).count();
+			best = min(best, elapsed);
+			total += elapsed;
+			++repetitions;
+		}
+		printf("%-34s %8zu reps %12.3f us %9.2f ns/token %9.1f MB/s\n", name.c_str(), repetitions, best*1e6,
+				tokens ? best*1e9/double(tokens) : 0.0, bytes ? double(bytes)/best/1e6 : 0.0);
+		fflush(stdout);
+	}
+
+	string number(size_t i) {
+		return to_string((i*2654435761u) % 1000000);
+	}
+
+	// 300 options of mixed types, each given once with one value
+	void manyOptions(const Settings& settings) {
+		const size_t count = 300;
+		Argv argv;
+		for (size_t i=0; i<count; ++i) {
+			argv.add("--option"+to_string(i));
+			argv.add(i%3 == 2 ? "value"+to_string(i) : number(i));
+		}
+		vector<int> ints(count);
+		vector<float> floats(count);
+		vector<string> strings(count);
+		auto registerAll = [&](Parser& parser) {
+			for (size_t i=0; i<count; ++i) {
+				string name = "--option"+to_string(i);
+				if (i%3 == 0) {
+					parser.addp(&ints[i], name, "An integer option.");
+				} else if (i%3 == 1) {
+					parser.addp(&floats[i], name, "A float option.");
+				} else {
+					parser.addp(&strings[i], name, "A string option.");
+				}
+			}
+		};
+		report(settings, "register 300 options", count, 0, [&]() {
+			Parser parser;
+			registerAll(parser);
+		});
+		Parser parser;
+		registerAll(parser);
+		char** args = argv.get();
+		report(settings, "parse 300 options", argv.size(), argv.bytes(), [&]() {
+			parser.argparse(args);
+		});
+	}
+
+	template<typename T> void numberList(const Settings& settings, const char* typeName, bool fraction) {
+		for (int exponent=3; exponent<=settings.scale; ++exponent) {
+			size_t count = 1;
+			for (int i=0; i<exponent; ++i) {
+				count *= 10;
+			}
+			Argv argv;
+			argv.add("--values");
+			for (size_t i=0; i<count; ++i) {
+				argv.add(fraction ? number(i)+"."+to_string(i%1000) : number(i));
+			}
+			char** args = argv.get();
+			report(settings, string("list -1 ")+typeName+" 10^"+to_string(exponent), count, argv.bytes(), [&]() {
+				vector<T> values;
+				Parser parser;
+				parser.addp(&values, -1, "--values", "The values.");
+				parser.argparse(args);
+			});
+		}
+	}
+
+	void stringList(const Settings& settings) {
+		for (int exponent=3; exponent<=settings.scale; ++exponent) {
+			size_t count = 1;
+			for (int i=0; i<exponent; ++i) {
+				count *= 10;
+			}
+			Argv argv;
+			argv.add("--files");
+			for (size_t i=0; i<count; ++i) {
+				argv.add("/data/run"+to_string(i%977)+"/output_"+to_string(i)+".csv");
+			}
+			char** args = argv.get();
+			report(settings, "list -1 string 10^"+to_string(exponent), count, argv.bytes(), [&]() {
+				vector<string> files;
+				Parser parser;
+				parser.addp(&files, -1, "--files", "The input files.");
+				parser.argparse(args);
+			});
+		}
+	}
+
+	// all values in one argv entry, as from --weights "$(cat weights.txt)"
+	void singleEntry(const Settings& settings) {
+		size_t count = 1000000;
+		string values;
+		for (size_t i=0; i<count; ++i) {
+			values += number(i);
+			values += ' ';
+		}
+		Argv argv;
+		argv.add("--values");
+		argv.add(values);
+		char** args = argv.get();
+		report(settings, "one entry int 10^6", count, argv.bytes(), [&]() {
+			vector<int> parsed;
+			Parser parser;
+			parser.addp(&parsed, -1, "--values", "The values.");
+			parser.argparse(args);
+		});
+		report(settings, "one entry int 10^6 parallel", count, argv.bytes(), [&]() {
+			vector<int> parsed;
+			Parser parser;
+			parser.addp(&parsed, -1, "--values", "The values.").parallel();
+			parser.argparse(args);
+		});
+		for (char& c : values) {
+			c = (c == ' ') ? ',' : c;
+		}
+		Argv joined;
+		joined.add("--values="+values);
+		char** joinedArgs = joined.get();
+		report(settings, "delimited int 10^6", count, joined.bytes(), [&]() {
+			vector<int> parsed;
+			Parser parser;
+			parser.addp(&parsed, -1, "--values", "The values.").delimiter(',');
+			parser.argparse(joinedArgs);
+		});
+	}
+
+	// the same number list read through a response file
+	void responseFile(const Settings& settings) {
+		size_t count = 1000000;
+		string path = "params_bench_response.txt";
+		FILE* file = fopen(path.c_str(), "w");
+		if (file == nullptr)
+			return;
+		fprintf(file, "--values\n");
+		size_t bytes = 9;
+		for (size_t i=0; i<count; ++i) {
+			string value = number(i);
+			fprintf(file, "%s\n", value.c_str());
+			bytes += value.size()+1;
+		}
+		fclose(file);
+		Argv argv;
+		argv.add("@"+path);
+		char** args = argv.get();
+		report(settings, "@file int 10^6", count, bytes, [&]() {
+			vector<int> values;
+			Parser parser;
+			parser.addp(&values, -1, "--values", "The values.");
+			parser.argparse(args);
+		});
+		report(settings, "@file int 10^6 parallel", count, bytes, [&]() {
+			vector<int> values;
+			Parser parser;
+			parser.addp(&values, -1, "--values", "The values.").parallel();
+			parser.argparse(args);
+		});
+		remove(path.c_str());
+	}
+
+	// --key=value everywhere and quoted strings spanning several argv entries
+	void equalsAndQuotes(const Settings& settings) {
+		const size_t count = 2000;
+		Argv argv;
+		for (size_t i=0; i<count; ++i) {
+			if (i%2 == 0) {
+				argv.add("--key"+to_string(i)+"="+number(i));
+			} else {
+				argv.add("--key"+to_string(i)+"=\"a quoted");
+				argv.add("string");
+				argv.add("with spaces "+to_string(i)+"\"");
+			}
+		}
+		vector<int> ints(count);
+		vector<string> strings(count);
+		Parser parser;
+		for (size_t i=0; i<count; ++i) {
+			string name = "--key"+to_string(i);
+			if (i%2 == 0) {
+				parser.addp(&ints[i], name, "An integer.");
+			} else {
+				parser.addp(&strings[i], name, "A quoted string.");
+			}
+		}
+		char** args = argv.get();
+		report(settings, "equals and quotes 2000 options", count*2, argv.bytes(), [&]() {
+			parser.argparse(args);
+		});
+	}
+
+	// the per value conversion alone, as Param::Set does it
+	template<typename T> void setter(const Settings& settings, const char* typeName, const vector<string>& texts) {
+		size_t bytes = 0;
+		for (const string& text : texts) {
+			bytes += text.size();
+		}
+		report(settings, string("set ")+typeName, texts.size(), bytes, [&]() {
+			vector<T> values;
+			values.reserve(texts.size());
+			const priv::Ops& ops = priv::Binding<vector<T>>::ops;
+			for (const string& text : texts) {
+				ops.assign(&values, 0, text, nullptr);
+			}
+		});
+	}
+
+	void setters(const Settings& settings) {
+		vector<string> integers, decimals, words;
+		for (size_t i=0; i<100000; ++i) {
+			integers.push_back(number(i));
+			decimals.push_back(number(i)+"."+to_string(i%1000));
+			words.push_back("word"+to_string(i));
+		}
+		setter<int>(settings, "int", integers);
+		setter<unsigned int>(settings, "uint", integers);
+		setter<long>(settings, "long", integers);
+		setter<float>(settings, "float", decimals);
+		setter<double>(settings, "double", decimals);
+		setter<char>(settings, "char", words);
+		setter<string>(settings, "string", words);
+	}
+
+	void details(const Settings& settings) {
+		const size_t count = 1000;
+		vector<int> ints(count);
+		vector<vector<double>> lists(count);
+		Parser parser;
+		for (size_t i=0; i<count; ++i) {
+			string name = "--option"+to_string(i);
+			if (i%2 == 0) {
+				parser.addp(&ints[i], to_string(i), name, "An integer option with a default value, described at some length.");
+			} else {
+				parser.addp(&lists[i], 3, false, name, "A list of three doubles.");
+			}
+		}
+		size_t bytes = parser.argdetails().size();
+		report(settings, "argdetails 1000 options", count, bytes, [&]() {
+			string text = parser.argdetails();
+			if (text.empty()) {
+				abort();
+			}
+		});
+		vector<char> buffer(bytes+1);
+		report(settings, "argdetails to buffer 1000 options", count, bytes, [&]() {
+			if (parser.argdetails(buffer.data(), buffer.size()) != bytes) {
+				abort();
+			}
+		});
+		FILE* null = fopen("/dev/null", "w");
+		if (null != nullptr) {
+			report(settings, "argdetails to FILE* 1000 options", count, bytes, [&]() {
+				parser.argdetails(null);
+			});
+			fclose(null);
+		}
+	}
+}
+
+int main(int argc, char* argv[]) {
+	(void)argc;
+	Settings settings;
+	bool help = false;
+	Parser options;
+	options.addp(&settings.scale, to_string(settings.scale), "--scale", "Largest list size as a power of 10 (3 to 7).");
+	options.addp(&settings.seconds, to_string(settings.seconds), "--seconds", "Minimum measuring time per workload.");
+	options.addp(&settings.filter, false, "--filter", "Only run workloads whose name contains this.");
+	options.addp(&help);
+	options.argparse(argv);
+	if (help) {
+		printf("%s\n", options.argdetails().c_str());
+		return 0;
+	}
+	settings.scale = max(3, min(7, settings.scale));
+
+	setters(settings);
+	manyOptions(settings);
+	equalsAndQuotes(settings);
+	numberList<int>(settings, "int", false);
+	numberList<double>(settings, "double", true);
+	stringList(settings);
+	singleEntry(settings);
+	responseFile(settings);
+	details(settings);
+	return 0;
+}
@@ -0,0 +1,297 @@
+// Scaling checks for params.h: counts the allocations and times argparse as the number of options and the
+// length of value lists double, and fails when a per token budget is exceeded or the cost per token grows
+// with the size, which is how super-linear behavior (rescanning, copying per token, regrowth) shows.
+// Growth is checked from the smallest size and from each size to the next, so a slowly bending curve
+// which stays under the overall ratio is still caught where it bends.
+//
+// Build and run from the repository root:
+//   g++ -std=c++17 -O2 -I. bench/params_scaling.cpp -o params_scaling -pthread
+//   ./params_scaling               // report and check, exits with 1 if a budget is exceeded
+//   ./params_scaling --scale 22    // lists up to 2^22 values
+//
+// Every size is parsed once to warm up and count the allocations of one parse, then repeated for
+// --seconds to take the best time, and measured again (twice at most) if it grew more than a step allows,
+// so one slow measure of a busy machine is not taken for growth. The budgets below are a few times what the engine measures now;
+// tighten them with an engine change that improves on them, never loosen them to make a change pass.
+
+#include "params.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <string>
+#include <vector>
+
+namespace {
+	std::atomic<size_t> allocations{0};
+}
+
+// not inlined, so the compiler does not take malloc() and free() in them for a mismatch with new and delete
+#if defined(__GNUC__)
+#define SCALING_NOINLINE __attribute__((noinline))
+#else
+#define SCALING_NOINLINE
+#endif
+
+SCALING_NOINLINE void* operator new(size_t size) {
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* memory = malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+SCALING_NOINLINE void* operator new[](size_t size) {
+	return operator new(size);
+}
+
+SCALING_NOINLINE void operator delete(void* memory) noexcept {
+	free(memory);
+}
+
+SCALING_NOINLINE void operator delete[](void* memory) noexcept {
+	free(memory);
+}
+
+SCALING_NOINLINE void operator delete(void* memory, size_t) noexcept {
+	free(memory);
+}
+
+SCALING_NOINLINE void operator delete[](void* memory, size_t) noexcept {
+	free(memory);
+}
+
+using namespace Params;
+
+namespace {
+	struct Settings {
+		int scale = 20; // longest list is 2^scale values
+		double seconds = 0.1; // minimum measuring time per size
+	};
+
+	// What one workload may cost, per token of its input.
+	struct Budget {
+		double allocations; // in one parse into variables already registered
+		double nanoseconds; // at the smallest size, a loose bound against accidents
+		double growth; // most the time per token may grow from the smallest size to any larger one
+		double step; // most it may grow from one size to the next, twice as large
+	};
+
+	// argv storage for a generated command line
+	class Argv {
+		private:
+			vector<string> words;
+			vector<char*> pointers;
+		public:
+			Argv() { words.push_back("params_scaling"); }
+			void add(string word) { words.push_back(move(word)); }
+			char** get() {
+				pointers.clear();
+				for (string& word : words) {
+					pointers.push_back(&word[0]);
+				}
+				pointers.push_back(nullptr);
+				return pointers.data();
+			}
+			size_t size() const { return words.size()-1; }
+	};
+
+	struct Measure {
+		size_t size;
+		size_t tokens;
+		double allocations; // per token
+		double nanoseconds; // per token
+	};
+
+	int violations = 0;
+
+	// the best time of step, repeated for at least settings.seconds
+	double best(const Settings& settings, const function<void()>& step) {
+		double fastest = 1e100, total = 0;
+		size_t repetitions = 0;
+		while (total < settings.seconds || repetitions < 3) {
+			auto started = chrono::steady_clock::now();
+			step();
+			double elapsed = chrono::duration<double>(chrono::steady_clock::now()-started).count();
+			fastest = min(fastest, elapsed);
+			total += elapsed;
+			++repetitions;
+		}
+		return fastest;
+	}
+
+	// one step at the next size, added to measures: its allocations once warm, its best time,
+	// measured again while it grew more than budget.step from the size before
+	void measure(const Settings& settings, vector<Measure>& measures, const Budget& budget, size_t size, size_t tokens, const function<void()>& step) {
+		step();
+		size_t before = allocations.load();
+		step();
+		size_t counted = allocations.load()-before;
+		double fastest = best(settings, step);
+		for (int retry=0; retry<2 && !measures.empty() && fastest*1e9/double(tokens) > measures.back().nanoseconds*budget.step; ++retry) {
+			fastest = min(fastest, best(settings, step));
+		}
+		measures.push_back(Measure{size, tokens, double(counted)/double(tokens), fastest*1e9/double(tokens)});
+	}
+
+	// prints the measures of a workload at its doubling sizes and checks them against the budget
+	void report(const string& name, const vector<Measure>& measures, const Budget& budget) {
+		printf("%s\n", name.c_str());
+		printf("  %10s %10s %14s %12s %8s %8s\n", "size", "tokens", "allocs/token", "ns/token", "growth", "step");
+		for (const Measure& m : measures) {
+			double growth = m.nanoseconds/measures.front().nanoseconds;
+			double step = (&m == &measures.front()) ? 1 : m.nanoseconds/(&m)[-1].nanoseconds;
+			string failed;
+			if (m.allocations > budget.allocations) {
+				failed += " allocations";
+			}
+			if (&m == &measures.front() && m.nanoseconds > budget.nanoseconds) {
+				failed += " time";
+			}
+			if (growth > budget.growth) {
+				failed += " growth";
+			}
+			if (step > budget.step) {
+				failed += " step";
+			}
+			printf("  %10zu %10zu %14.4f %12.2f %8.2f %8.2f%s%s\n", m.size, m.tokens, m.allocations, m.nanoseconds, growth, step,
+					failed.empty() ? "" : "  OVER BUDGET:", failed.c_str());
+			violations += !failed.empty();
+		}
+		printf("  budget: %.4f allocs/token, %.0f ns/token, growth %.1f, step %.1f\n\n", budget.allocations, budget.nanoseconds, budget.growth, budget.step);
+		fflush(stdout);
+	}
+
+	// options of mixed types given once each, parsed again into the same variables
+	void options(const Settings& settings) {
+		Budget budget{0.01, 120, 2.5, 1.5};
+		vector<Measure> measures;
+		for (size_t count=64; count<=8192; count*=2) {
+			Argv argv;
+			for (size_t i=0; i<count; ++i) {
+				argv.add("--option"+to_string(i));
+				argv.add(to_string(i*7));
+			}
+			vector<int> ints(count);
+			vector<double> doubles(count);
+			vector<string> strings(count);
+			Parser parser;
+			for (size_t i=0; i<count; ++i) {
+				string name = "--option"+to_string(i);
+				if (i%3 == 0) {
+					parser.addp(&ints[i], name, "An integer.");
+				} else if (i%3 == 1) {
+					parser.addp(&doubles[i], name, "A double.");
+				} else {
+					parser.addp(&strings[i], name, "A string.");
+				}
+			}
+			char** args = argv.get();
+			measure(settings, measures, budget, count, argv.size(), [&]() { parser.argparse(args); });
+		}
+		report("options given once, by option count", measures, budget);
+	}
+
+	// registering the options, with their defaults, into a new parser, in an order unrelated to their names
+	// (an odd multiplier permutes the indices modulo a power of 2) so nothing gains from sorted input
+	void registration(const Settings& settings) {
+		Budget budget{1.5, 500, 2.5, 1.5};
+		vector<Measure> measures;
+		for (size_t count=64; count<=8192; count*=2) {
+			vector<int> ints(count);
+			vector<string> names, defaults;
+			for (size_t i=0; i<count; ++i) {
+				names.push_back("--option"+to_string((i*2654435761u) & (count-1)));
+				defaults.push_back(to_string(i));
+			}
+			Argv none;
+			char** args = none.get();
+			measure(settings, measures, budget, count, count, [&]() {
+				Parser parser;
+				for (size_t i=0; i<count; ++i) {
+					parser.addp(&ints[i], defaults[i], names[i], "An integer with a default.");
+				}
+				parser.argparse(args);
+			});
+		}
+		report("registration and defaults, by option count", measures, budget);
+	}
+
+	// one list option with a doubling number of values, each value an argv entry, or all of them in one
+	template<typename T> void list(const Settings& settings, const char* name, bool joined, const function<string(size_t)>& value, const Budget& budget) {
+		vector<Measure> measures;
+		for (int exponent=10; exponent<=settings.scale; ++exponent) {
+			size_t count = size_t(1) << exponent;
+			Argv argv;
+			argv.add("--values");
+			string all;
+			for (size_t i=0; i<count; ++i) {
+				if (joined) {
+					all += value(i);
+					all += ' ';
+				} else {
+					argv.add(value(i));
+				}
+			}
+			if (joined) {
+				argv.add(move(all));
+			}
+			char** args = argv.get();
+			vector<T> values;
+			Parser parser;
+			parser.addp(&values, -1, "--values", "The values.");
+			measure(settings, measures, budget, count, count, [&]() {
+				values.clear(); // keeps the capacity, as a program parsing again would
+				parser.argparse(args);
+			});
+		}
+		report(name, measures, budget);
+	}
+
+	string number(size_t i) {
+		return to_string((i*2654435761u) % 1000000);
+	}
+}
+
+int main(int argc, char* argv[]) {
+	(void)argc;
+	Settings settings;
+	bool help = false;
+	Parser arguments;
+	arguments.addp(&settings.scale, to_string(settings.scale), "--scale", "Longest list as a power of 2 (10 to 24).");
+	arguments.addp(&settings.seconds, to_string(settings.seconds), "--seconds", "Minimum measuring time per size.");
+	arguments.addp(&help);
+	arguments.argparse(argv);
+	if (help) {
+		printf("%s\n", arguments.argdetails().c_str());
+		return 0;
+	}
+	settings.scale = max(10, min(24, settings.scale));
+#if defined(__GLIBC__)
+	// keeps freed memory in the process: by default glibc hands large blocks back to the kernel, so every new
+	// parser of a few thousand options page faults its memory in again, which shows as a step at whichever
+	// size first crosses the threshold rather than as anything the engine does per token
+	mallopt(M_MMAP_THRESHOLD, 256 << 20);
+	mallopt(M_TRIM_THRESHOLD, 512 << 20);
+#endif
+
+	options(settings);
+	registration(settings);
+	auto decimal = [](size_t i) { return number(i)+"."+to_string(i%1000); };
+	auto path = [](size_t i) { return "/data/run/output_"+to_string(i)+".csv"; }; // too long for a short string
+	list<int>(settings, "int list, a value per argv entry, by length", false, number, Budget{0.01, 120, 2.5, 1.5});
+	list<int>(settings, "int list, all values in one argv entry, by length", true, number, Budget{0.01, 40, 2.5, 1.5});
+	list<double>(settings, "double list, all values in one argv entry, by length", true, decimal, Budget{0.01, 60, 2.5, 1.5});
+	list<string>(settings, "string list, a value per argv entry, by length", false, path, Budget{1.01, 250, 2.5, 1.5}); // the strings themselves
+	if (violations != 0) {
+		printf("%d measures over budget\n", violations);
+		return 1;
+	}
+	printf("all measures within budget\n");
+	return 0;
+}
@@ -21,13 +21,10 @@
 // Features
 // * Easy to use yet powerful
 // * Only one file to include
-// * Written in C++11 for extra clarity
+// * Written in C++17 for extra clarity
 // * Produces help-style parameter details as a string for inclusion (string argdetails())
 // * Enforces help messages for each parameter (no lazy programming!)
 // 
-// To Do
-// * Check for option aliasing
-//
 // Usage
 // simply include this header file in your c++ project. #include "params.h"
 // How it works is you must declare all the variables which represent flags or parameters
@@ -38,24 +35,88 @@
 //
 // Notes
 // * "--seed" options don't require dashes. Could use "-s" or "seed" or "s" etc.
+// * An option may have more names, which must not be taken by another option: addp(...).alias("-s");
+// *   Short flags (BOOL options named "-v", "-q") may be given together as -vq.
+// *   allowPrefixes() also accepts an unambiguous start of a name, such as --iter for --iterations.
 // * Supports equals sign or space: 1) --seed 3   2) --seed=3
 // * A TYPE::BOOL will be true or false depending if it exists, such as "--verbose" would be a good use.
 // * Strings with spaces require escaped quotes (to prevent shell expansion): --username \"Jory Schossau\"
+// *   An equals sign inside quotes is kept as part of the string: --filter \"a=b\"
 // * Default values are specified as a string before the option in addp: "3.14" or "-9" or "User" for example.
 // * Options which need more than 1 argument may be specified as an integer after the variable:
 // *   addp(TYPE::INT, &quantity, 3, "--quantity", "The quantity of materials to simulate.");
 // *   would require an invocation option like this: --quantity 88 28 53
 // *   and it will give an error for != 3 arguments specified.
-// *   Requires the variable to be a vector.
+// *   Requires the variable to be a vector, or to have room for them already: an array<T,N>, a Buffer<T>
+// *   over your own memory, or a span<T> in C++20. These are written in place and the count may be left out:
+// *   array<int,3> rgb; addp(&rgb, "--rgb", "The color."); // --rgb 255 128 0
+// * Arguments can be read from a response file with @path, for example: --files @list.txt
+// *   The file is tokenized like the command line, where newlines and tabs also separate.
+// *   Response files are not nested, and a quoted "@name" is taken literally. @- reads stdin, a chunk at a time.
+// * To process a long list without holding it, bind the option to a Sink, which is handed each value as it is parsed:
+// *   Sink<string_view> files{[](string_view file) { process(file); }}; addp(&files, -1, "--files", "The files.");
+// * An option whose values are often not read can bind to a Lazy, which keeps their text and converts it on first use:
+// *   Lazy<vector<double>> trace; addp(&trace, -1, false, "--trace", "..."); trace.get() converts, tryGet() does not exit.
 // * Options which need infinite arguments (such as a list of files) are specified as a -1:
 // *   addp(TYPE::INT, &quantity, -1, "--quantity", "The quantities to use of n items.");
 // *   would require an invocation option like this: --quantity 17 16 62 21 31 42 98 34 52
+// * Lists may also take their values joined in one token, once the option is given a delimiter:
+// *   addp(&weights, -1, "--weights", "The weights.").delimiter(','); // --weights=0.1,0.2,0.7
+// *   Each value counts toward xargs, empty pieces are skipped and quoted tokens are not split.
+// *   Long lists of INT, UINT, LONG, FLOAT or DOUBLE from a response file or a single argv entry
+// *   are split and converted in bulk (with SSE4.2 or AVX2 where the CPU has it), with the same results.
+// *   .parallel() spreads that over all cores for lists of many megabytes, .parallel(8) over 8 threads.
+// * Values can be constrained; each one is checked as it is converted, and argdetails() lists the constraints:
+// *   addp(&rate, "--rate", "...").range(0, 1); addp(&mode, "--mode", "...").choices({"fast", "exact"});
+// *   addp(&sizes, -1, "--sizes", "...").check([](int size) { return size%2 == 0; }, "even");
 // * To make an option not required, give it a default value, or specify 'false' for required. BOOL cannot be required.
 // * The "--help" option is provided for you, you simply need to specify the boolean.
 // *   If the --help option is specified then no other arguments will be read:
 // *   addp(TYPE::BOOL, &showhelp);
+// * The TYPE can be left out, then it follows from the variable and is checked at compile time:
+// *   addp(&iterations, "--iterations", "The number of iterations to perform."); // int
+// *   addp(&seeds, 3, false, "--seeds", "The seeds to begin simulation."); // vector<float>
+// * The options may also be the members of one config struct, which then holds related values together:
+// *   addFields(config, field(&Config::iterations, "--iterations", "..."), field(&Config::weights, "--weights", "..."));
+// *   The count follows from the member: a vector takes any number of values, an array<T,N> takes N.
 // * Print help details for parameters with argdetails(), such as:
 // *   cout << argdetails() << endl;
+// *   The text is cached until the options change. argdetails(stdout) or argdetails(cout) stream it instead,
+// *   and argdetails(buffer, size) fills a buffer like snprintf.
+// * tryparse(argv) reports a bad invocation instead of exiting, and then leaves the variables unchanged:
+// *   if (Error error = tryparse(argv)) { fprintf(stderr, "%s\n", errordetails().c_str()); }
+// * reset() forgets all registered options and releases their storage, so a new set can be registered.
+// * The free functions use one default parser. For independent option sets, e.g. one per thread,
+// *   make a Params::Parser and call the same functions on it: parser.addp(...); parser.argparse(argv);
+// * All translation units including this share one default parser. In a large build, define PARAMS_DECLARATIONS_ONLY
+// *   everywhere and PARAMS_IMPLEMENTATION in one .cpp to compile the parser there only, see PARAMS_API.
+// * Define PARAMS_STATS before including to get per parse figures (tokens, lookups, conversions per TYPE,
+// *   estimated allocations and time per phase) from stats(), or from Parser::stats() and Result::stats().
+// * A config file of the same options (one --key=value per line, '#' starts a comment line) can be reloaded
+// *   while the program runs, and read from any thread without locking:
+// *   Schema schema = compile(); Reloader tunables(schema, "server.conf"); tunables.watch(chrono::seconds(1));
+// *   Snapshot now = tunables.snapshot(); const double* rate = now ? now->get<double>("--rate") : nullptr;
+// *   In a config file the values of an option end with its line, so lists of any length may be given.
+// * Options may also come from a config file and from environment variables with a prefix, read in one pass
+// *   with argv; a later source replaces what an earlier one gave, and required options are checked at the end:
+// *   argparse(Sources{"sim.conf", "SIM_", argv}); // SIM_NUM_THREADS=8 is --num-threads 8, argv wins over both
+// *   An environment variable of a BOOL sets the flag unless it is empty, 0 or false. A variable with the prefix
+// *   which names no option is skipped, as the shell may hold others of the same prefix.
+// * Processes started again and again with the same huge arguments can skip parsing with a cache file,
+// *   which holds the converted values keyed by the options and argv: argparse(argv, "/tmp/sim.cache");
+// * A master process can publish() the parsed values to shared memory for the workers it forks, which read them
+// *   through the View without parsing or copying: View shared = publish(); shared.list<double>("--weights")[0];
+// * A tool with subcommands registers each one's options in a function run only when argv names the command,
+// *   so the others are never registered nor checked: command("train", "Trains.", [&](Parser& p) { p.addp(...); });
+// *   argparse(argv); // tool --verbose train --epochs 3, then activeCommand() is "train"
+// * Options known at compile time can be declared in a constexpr table instead: the lookup index and the help
+// *   text are then built by the compiler, and a StaticParser parses without registering or allocating:
+// *   static constexpr StaticOption options[] = {option(&iterations, "--iterations", "..."), option(&help)};
+// *   static StaticParser<options> parser; parser.argparse(argv); // parser.argdetails() is a constant
+// * To check many command lines against the same options, compile them once and parse into Results,
+// *   which own their values and leave the bound variables alone:
+// *   Schema schema = compile(); vector<Result> runs = schema.parse(batch, 8); // batch of argv, 8 threads
+// *   if (runs[0].ok()) { const int* iterations = runs[0].get<int>("--iterations"); }
 //
 // Example:
 /*
@@ -84,363 +145,4712 @@ int main(int argc, char* argv[]) {
 #pragma once
 
 #include <cstdio>
-#include <map>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+#include <charconv>
+#include <system_error>
 #include <string>
+#include <string_view>
 #include <initializer_list>
 #include <cassert>
 #include <vector>
+#include <array>
+#include <ostream>
 #include <locale>
 #include <stdexcept>
+#include <type_traits>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#define PARAMS_HAVE_SPAN 1
+#endif
+#endif
+#ifndef PARAMS_HAVE_SPAN
+#define PARAMS_HAVE_SPAN 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define PARAMS_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define PARAMS_HAVE_MMAP 0
+#endif
+
+// SSE4.2 and AVX2 kernels for bulk lists are compiled with target attributes and chosen at runtime.
+#if PARAMS_HAVE_MMAP
+extern char** environ;
+#endif
+
+// By default everything is inline and any number of translation units may include this header.
+// To compile the non-template code once, define PARAMS_DECLARATIONS_ONLY for the whole build
+// and PARAMS_IMPLEMENTATION in the one .cpp which should hold it, before including this header.
+// Templates and what they need stay in the header in all modes. PARAMS_STATS must be the same everywhere.
+#if defined(PARAMS_IMPLEMENTATION)
+#define PARAMS_API
+#define PARAMS_DEFINE 1
+#elif defined(PARAMS_DECLARATIONS_ONLY)
+#define PARAMS_API
+#define PARAMS_DEFINE 0
+#else
+#define PARAMS_API inline
+#define PARAMS_DEFINE 1
+#endif
+
+// Threads are only started by the non-template code: the workers of parallel lists, Schema::parse
+// of a batch and Reloader::watch. The declarations hold no thread state, so they need none of these.
+#if PARAMS_DEFINE
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PARAMS_HAVE_X86_SIMD 1
+#include <immintrin.h>
+#else
+#define PARAMS_HAVE_X86_SIMD 0
+#endif
 
 namespace Params {
 	using namespace std;
 
 	enum class TYPE {BOOL, INT, UINT, FLOAT, LONG, DOUBLE, CHAR, STRING};
 	enum class OPT : int {XARGS=1, REQUIRED=2}; // just be powers of 2
+	// why a parse failed, see tryparse
+	enum class Failure {NONE, UNKNOWN_OPTION, BAD_VALUE, OUT_OF_RANGE, MISSING_REQUIRED, UNREADABLE_FILE, TOO_MANY_VALUES, AMBIGUOUS_OPTION, NOT_ALLOWED};
+
+	// Figures of the last parse, gathered only when PARAMS_STATS is defined before including this header.
+	// Otherwise the struct is empty and the instrumentation compiles to nothing.
+	// Timing takes a clock reading per token, so parses are slower while it is on.
+	struct Stats {
+#ifdef PARAMS_STATS
+		size_t tokens = 0;
+		size_t bytes = 0; // input scanned by the tokenizer
+		size_t lookups = 0;
+		size_t converted[8] = {}; // values converted, indexed by TYPE
+		// heap allocations by the parser itself, including regrowth of list destinations: an estimate from the
+		// capacity changes of its buffers and destinations, not a count of calls to the allocator
+		size_t allocations = 0;
+		double tokenizeSeconds = 0;
+		double lookupSeconds = 0;
+		double convertSeconds = 0;
+		double validateSeconds = 0; // required check and default fill
+#endif
+	};
+
+	// Caller owned storage for an option with a fixed count, written in place without allocating:
+	//   int sizes[3]; Buffer<int> buffer{sizes, 3}; addp(&buffer, "--sizes", "Three sizes.");
+	template<typename T> struct Buffer {
+		T* data;
+		size_t size;
+	};
+
+	// A destination which is handed the values one at a time as they are parsed, instead of keeping them,
+	// so a list of any length is never held at once. T is a supported type, or string_view for the text
+	// itself, which is only valid during the call:
+	//   Sink<string_view> files{[](string_view file) { process(file); }};
+	//   addp(&files, -1, "--files", "The files to process."); // --files @- takes them from stdin
+	template<typename T> struct Sink {
+		function<void(const T&)> consume;
+	};
+
+	namespace priv {
+		template<typename T> struct Binding;
+		struct Constraint;
+	}
+
+	// A destination which keeps its values as they were given and converts them the first time they are
+	// asked for, so an option the program does not read costs no conversion. T is a single value or a vector
+	// of a supported type (but bool). Whether a required option was given is still checked by the parse.
+	//   Lazy<vector<double>> trace; addp(&trace, -1, false, "--trace", "Points to debug.");
+	//   if (debugging) { for (double point : trace.get()) { ... } } // converted here, once
+	// Like the bound variables, a Lazy is not locked: call get() once before sharing it between threads.
+	// The values are checked against the constraints of the option then, a copy of which the Lazy keeps,
+	// so the parser may be destroyed or reset() before.
+	template<typename T> class Lazy {
+		public:
+			const T& get() const; // the values, converted on the first call; exits on a bad one
+			const T* tryGet() const; // the same, nullptr on a bad value, see error()
+			string error() const; // why tryGet() gave nullptr, empty if the values converted
+			size_t size() const { return ends.size(); } // values given, the default included, without converting them
+		private:
+			template<typename> friend struct priv::Binding;
+			string texts; // the values, each ended by a newline
+			vector<size_t> ends; // of value i in texts, where its newline is
+			bool plain = true; // no value is empty or holds a separator, so a numeric list converts in bulk
+			string name; // of the option, for error()
+			shared_ptr<const priv::Constraint> constraint; // a copy of that of the option, see priv::keepConstraint
+			mutable T value{};
+			mutable errc result{};
+			mutable size_t failed = 0; // the value which did not convert
+			mutable bool converted = false;
+			void convert() const;
+			string_view text(size_t i) const { size_t begin = (i == 0) ? 0 : ends[i-1]+1; return string_view(texts).substr(begin, ends[i]-begin); }
+	};
+
+	// Where argparse(Sources) reads the options from, each one optional, in order of precedence
+	// from lowest to highest. An option given by a later source replaces what an earlier one gave.
+	//   argparse(Sources{"/etc/sim.conf", "SIM_", argv}); // SIM_NUM_THREADS=8 gives --num-threads 8
+	struct Sources {
+		const char* config = nullptr; // path of a config file, one --key=value per line, see Reloader
+		// prefix of the environment variables to read; those naming no option are skipped, not an error,
+		// since other programs may use the same prefix for their own settings
+		const char* environment = nullptr;
+		char** argv = nullptr;
+	};
+
+#ifdef PARAMS_STATS
+#define PARAMS_STAT(...) __VA_ARGS__
+#else
+#define PARAMS_STAT(...)
+#endif
 
 	namespace priv {
+		// A contiguous piece of input for the bulk converters: an argv entry, a response file or part of one.
+		struct Span {
+			const char* begin;
+			const char* end;
+		};
+		static const size_t parallelPiece = size_t(1) << 18; // input bytes worth a thread of bulk conversion
+		class Workers;
+
+		// Limits on the values of an option, see Option::range, choices and check, tested on each value as it is
+		// converted; a value outside them fails with errc::argument_out_of_domain. Made in the registry's arena,
+		// like the strings.
+		struct Constraint {
+			bool bounded = false; // numeric values from low to high
+			double low = 0; // of FLOAT and DOUBLE options
+			double high = 0;
+			long long lowInteger = 0; // of INT, UINT and LONG options, compared exactly
+			long long highInteger = 0;
+			vector<string_view> choices; // of a STRING or CHAR option, any if empty
+			function<bool(const void*)> predicate; // of the converted value, a string_view for STRING
+			string_view described; // what the predicate wants, as in "must be ..."
+			string_view rule; // all of the above in one line, for errors
+			string_view help; // the same as lines of argdetails()
+			size_t serial = 0; // new whenever the constraint changes, its copies keep it
+		};
+		// kept becomes a copy of constraint which owns its strings, unless it is one already
+		PARAMS_API void keepConstraint(shared_ptr<const Constraint>& kept, const Constraint* constraint);
+		// whether the constraint, if any, allows value
+		template<typename T> bool admits(const Constraint* constraint, const T& value);
+
+		// A bound given to Option::range, an integer kept exact beside its nearest double.
+		struct Bound {
+			bool integral;
+			long long integer; // if integral, an unsigned beyond the range of long long at its maximum
+			double real;
+			template<typename N, typename = typename enable_if<is_arithmetic<N>::value>::type> constexpr Bound(N n)
+				: integral(is_integral<N>::value), integer(!is_integral<N>::value ? 0
+					: (is_unsigned<N>::value && (unsigned long long)n > (unsigned long long)LLONG_MAX) ? LLONG_MAX : (long long)n), real(double(n)) {}
+		};
+
+		// Type specific operations on a destination, one static table per Binding<T>.
+		struct Ops {
+			// converts and stores one value: appended to a list, at index of a fixed count destination
+			errc (*assign)(void* destination, size_t index, string_view value, const Constraint* constraint);
+			void (*reserve)(void* destination, size_t count); // room for count more values in a list
+			errc (*fill)(void* destination, size_t index, size_t count, string_view value, const Constraint* constraint); // count copies of value from index on, converted once
+			void* (*create)(const void* like); // a new default value the size of like, for results not bound to a variable
+			void (*destroy)(void* value);
+			size_t (*capacity)(const void* destination); // of a list, to notice regrowth
+			void* (*stage)(const void* destination); // a value to parse into instead: a copy of a single value, an empty list
+			void (*commit)(void* destination, void* staged); // moves the staged value over, or appends the staged list
+			// converts the plain values at the front of the spans in order, on up to threads threads, see convertSpans;
+			// stopped is the first span not converted to its end, with its begin moved to where that stopped (count if none)
+			// nullptr if not a numeric list
+			size_t (*bulk)(void* destination, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned threads, Workers& workers, const Constraint* constraint);
+			size_t (*length)(const void* destination); // values held by a list
+			void (*truncate)(void* destination, size_t count); // drops the values of a list after the first count
+			// cache encoding, see saveCache: the value, or the values of a list from index from on
+			void (*save)(const void* destination, size_t from, string& out); // nullptr if the values cannot be cached
+			// decodes what save wrote: replaces a value, appends to a list; with write false only checks that it would fit
+			bool (*load)(void* destination, string_view bytes, bool write);
+		};
+
 		class Param {
 			private:
 			public:
 				TYPE type;
-				void* destination;
-				string longPhrase;
-				string helpPhrase;
+				const Ops* ops;
+				void* destination; // bound variable, in a Schema an unbound value shaped like it
+				string_view longPhrase; // the strings live in the registry's arena
+				string_view helpPhrase;
 				int xargs;
-            int xargsRead; // how many of the required arguments have been set by the user
 				bool required;
-				bool set; // if required then should be set by end of arparse (we check)
-				string defaultValue;
-				Param(TYPE _type, void* _destination, string _longPhrase, string _helpPhrase, int _xargs=1, bool _required=true, string _defaultValue="");
-				void Set(string _value);
+				bool list; // destination is a vector, values are appended, or a fixed count destination
+				string_view defaultValue;
+				size_t id; // position in the registry, assigned when the index is built
+				char delimiter; // list values may also be given as one token split at this, 0 for none
+				unsigned threads; // converting the plain values of a list in bulk, 0 for one per core
+				Constraint* constraint; // limits on the values, nullptr for none
+				struct Alias* aliases; // other names, in the order given
+				constexpr Param(TYPE _type, const Ops* _ops, bool _list, void* _destination, string_view _longPhrase, string_view _helpPhrase, int _xargs=1, bool _required=true, string_view _defaultValue="");
+				void Set(void* _destination, string_view _value) const; // for defaults, exits on a bad value
+				void SetDefault(void* _destination) const; // the registration time default of single value options
+		};
+
+		// Binding<T> describes a destination of type T: its TYPE and its Ops.
+		// Supported are bool, int, unsigned int, long, float, double, char, string and vectors of those,
+		// and for fixed counts array<T,N>, Buffer<T> and span<T> of those (but bool), Sink<T> and Lazy<T>.
+		template<typename T> struct TypeOf {
+			static_assert(!is_same<T,T>::value, "Unsupported option type, see TYPE for the supported ones.");
+		};
+		template<> struct TypeOf<bool> { static constexpr TYPE type = TYPE::BOOL; };
+		template<> struct TypeOf<int> { static constexpr TYPE type = TYPE::INT; };
+		template<> struct TypeOf<unsigned int> { static constexpr TYPE type = TYPE::UINT; };
+		template<> struct TypeOf<float> { static constexpr TYPE type = TYPE::FLOAT; };
+		template<> struct TypeOf<long> { static constexpr TYPE type = TYPE::LONG; };
+		template<> struct TypeOf<double> { static constexpr TYPE type = TYPE::DOUBLE; };
+		template<> struct TypeOf<char> { static constexpr TYPE type = TYPE::CHAR; };
+		template<> struct TypeOf<string> { static constexpr TYPE type = TYPE::STRING; };
+
+		template<typename T> struct Binding {
+			static constexpr TYPE type = TypeOf<T>::type;
+			static constexpr bool list = false;
+			static constexpr bool fixed = false;
+			static errc assign(void* destination, size_t, string_view value, const Constraint* constraint);
+			static void reserve(void*, size_t) {}
+			static errc fill(void* destination, size_t, size_t, string_view value, const Constraint* constraint) { return assign(destination, 0, value, constraint); }
+			static void* create(const void*) { return new T(); }
+			static void destroy(void* value) { delete static_cast<T*>(value); }
+			static size_t capacity(const void*) { return 0; }
+			static void* stage(const void* destination) { return new T(*static_cast<const T*>(destination)); }
+			static void commit(void* destination, void* staged) { *static_cast<T*>(destination) = move(*static_cast<T*>(staged)); }
+			static size_t length(const void*) { return 1; }
+			static void truncate(void*, size_t) {}
+			static void save(const void* destination, size_t, string& out);
+			static bool load(void* destination, string_view bytes, bool write);
+			static const Ops ops;
+		};
+		template<typename T> struct Binding<vector<T>> {
+			static constexpr TYPE type = TypeOf<T>::type;
+			static constexpr bool list = true;
+			static constexpr bool fixed = false;
+			static errc assign(void* destination, size_t, string_view value, const Constraint* constraint);
+			static void reserve(void* destination, size_t count);
+			static errc fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint);
+			static void* create(const void*) { return new vector<T>(); }
+			static void destroy(void* value) { delete static_cast<vector<T>*>(value); }
+			static size_t capacity(const void* destination) { return static_cast<const vector<T>*>(destination)->capacity(); }
+			static size_t bulk(void* destination, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned threads, Workers& workers, const Constraint* constraint);
+			static void* stage(const void*) { return new vector<T>(); }
+			static void commit(void* destination, void* staged);
+			static size_t length(const void* destination) { return static_cast<const vector<T>*>(destination)->size(); }
+			static void truncate(void* destination, size_t count) { static_cast<vector<T>*>(destination)->resize(min(count, length(destination))); }
+			static void save(const void* destination, size_t from, string& out);
+			static bool load(void* destination, string_view bytes, bool write);
+			static constexpr bool numeric = is_arithmetic<T>::value && !is_same<T,bool>::value && !is_same<T,char>::value;
+			static const Ops ops;
+		};
+
+		// Storage of the fixed count destinations. Values made by make() own their elements.
+		template<typename H> struct Fixed;
+		template<typename T, size_t N> struct Fixed<array<T,N>> {
+			typedef T value_type;
+			static T* data(const void* holder) { return const_cast<T*>(static_cast<const array<T,N>*>(holder)->data()); }
+			static size_t size(const void*) { return N; }
+			static void* make(size_t) { return new array<T,N>(); }
+			static void release(void* holder) { delete static_cast<array<T,N>*>(holder); }
+		};
+		template<typename T> struct Fixed<Buffer<T>> {
+			typedef T value_type;
+			static T* data(const void* holder) { return static_cast<const Buffer<T>*>(holder)->data; }
+			static size_t size(const void* holder) { return static_cast<const Buffer<T>*>(holder)->size; }
+			static void* make(size_t size) { return new Buffer<T>{new T[size](), size}; }
+			static void release(void* holder) { delete[] static_cast<Buffer<T>*>(holder)->data; delete static_cast<Buffer<T>*>(holder); }
+		};
+#if PARAMS_HAVE_SPAN
+		template<typename T> struct Fixed<span<T>> {
+			typedef T value_type;
+			static T* data(const void* holder) { return static_cast<const span<T>*>(holder)->data(); }
+			static size_t size(const void* holder) { return static_cast<const span<T>*>(holder)->size(); }
+			static void* make(size_t size) { return new span<T>(new T[size](), size); }
+			static void release(void* holder) { delete[] static_cast<span<T>*>(holder)->data(); delete static_cast<span<T>*>(holder); }
+		};
+#endif
+
+		// A fixed count destination: values are written in place at their index, capacity is the size.
+		template<typename H> struct FixedBinding {
+			typedef typename Fixed<H>::value_type T;
+			static_assert(!is_same<T,bool>::value, "BOOL options are flags and bind to a bool.");
+			static constexpr TYPE type = TypeOf<T>::type;
+			static constexpr bool list = true;
+			static constexpr bool fixed = true;
+			static errc assign(void* destination, size_t index, string_view value, const Constraint* constraint);
+			static void reserve(void*, size_t) {}
+			static errc fill(void* destination, size_t index, size_t count, string_view value, const Constraint* constraint);
+			static void* create(const void* like) { return Fixed<H>::make(Fixed<H>::size(like)); }
+			static void destroy(void* value) { Fixed<H>::release(value); }
+			static size_t capacity(const void* destination) { return Fixed<H>::size(destination); }
+			static void* stage(const void* destination);
+			static void commit(void* destination, void* staged);
+			static size_t length(const void* destination) { return Fixed<H>::size(destination); }
+			static void truncate(void*, size_t) {} // values are overwritten in place
+			static void save(const void* destination, size_t, string& out);
+			static bool load(void* destination, string_view bytes, bool write);
+			static const Ops ops;
+		};
+		// A Sink destination: values are converted and passed on as they come, nothing is kept.
+		// Values cannot be taken back, so tryparse and later Sources do not undo what a sink was given,
+		// and a parse with a sink is not cached. A Schema calls a copy of the callback.
+		template<typename T> struct SinkType { static constexpr TYPE type = TypeOf<T>::type; };
+		template<> struct SinkType<string_view> { static constexpr TYPE type = TYPE::STRING; };
+		template<typename T> struct Binding<Sink<T>> {
+			static constexpr TYPE type = SinkType<T>::type;
+			static constexpr bool list = true;
+			static constexpr bool fixed = false;
+			static errc assign(void* destination, size_t, string_view value, const Constraint* constraint);
+			static void reserve(void*, size_t) {}
+			static errc fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint);
+			static void* create(const void* like) { return new Sink<T>(*static_cast<const Sink<T>*>(like)); }
+			static void destroy(void* value) { delete static_cast<Sink<T>*>(value); }
+			static size_t capacity(const void*) { return 0; }
+			static size_t bulk(void* destination, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned threads, Workers& workers, const Constraint* constraint);
+			static void* stage(const void* destination); // forwards to the bound sink
+			static void commit(void*, void*) {}
+			static size_t length(const void*) { return 0; }
+			static void truncate(void*, size_t) {}
+			static constexpr bool numeric = is_arithmetic<T>::value && !is_same<T,bool>::value && !is_same<T,char>::value;
+			static const Ops ops;
+		};
+		// A Lazy destination: the parse only records the text of the values, Lazy::get() converts them.
+		// Neither cached nor published, whose records are converted values.
+		template<typename T> struct IsVector { static constexpr bool value = false; };
+		template<typename T> struct IsVector<vector<T>> { static constexpr bool value = true; };
+		template<typename T> struct Binding<Lazy<T>> {
+			static_assert(IsVector<T>::value || !Binding<T>::list, "A Lazy holds a single value or a vector.");
+			static_assert(Binding<T>::type != TYPE::BOOL, "BOOL options are flags and bind to a bool.");
+			static constexpr TYPE type = Binding<T>::type;
+			static constexpr bool list = Binding<T>::list;
+			static constexpr bool fixed = false;
+			static errc assign(void* destination, size_t, string_view value, const Constraint* constraint) { return fill(destination, 0, 1, value, constraint); }
+			static void reserve(void* destination, size_t count);
+			static errc fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint);
+			static void* create(const void* like) { return stage(like); }
+			static void destroy(void* value) { delete static_cast<Lazy<T>*>(value); }
+			static size_t capacity(const void* destination) { return static_cast<const Lazy<T>*>(destination)->ends.capacity(); }
+			static void* stage(const void* destination); // an empty one for a list, a copy of a single value
+			static void commit(void* destination, void* staged);
+			static size_t length(const void* destination) { return list ? static_cast<const Lazy<T>*>(destination)->ends.size() : 1; }
+			static void truncate(void* destination, size_t count);
+			static void named(Lazy<T>* destination, string_view name) { destination->name = name; }
+			static const Ops ops;
+		};
+		template<typename T> struct IsLazy { static constexpr bool value = false; };
+		template<typename T> struct IsLazy<Lazy<T>> { static constexpr bool value = true; };
+
+		template<typename T, size_t N> struct Binding<array<T,N>> : FixedBinding<array<T,N>> {};
+		template<typename T> struct Binding<Buffer<T>> : FixedBinding<Buffer<T>> {};
+#if PARAMS_HAVE_SPAN
+		template<typename T> struct Binding<span<T>> : FixedBinding<span<T>> {};
+#endif
+
+		// Locale independent conversion of a whole token, reported through the return code:
+		// errc::invalid_argument for empty input or trailing characters, and
+		// errc::result_out_of_range for values that do not fit in T. Never allocates or throws.
+		template<typename T> errc convert(string_view text, T& value);
+
+		// Bump allocator handing out memory from a list of growing blocks.
+		// Everything is released at once by clear(), which keeps the newest block for reuse.
+		class Arena {
+			private:
+				struct Block {
+					Block* previous;
+					size_t size; // usable bytes after the header
+					size_t used;
+				};
+				struct Finalizer {
+					void (*destroy)(void*);
+					void* object;
+				};
+				Block* head = nullptr;
+				vector<Finalizer> finalizers; // for objects which are not trivially destructible
+			public:
+				Arena() = default;
+				Arena(const Arena&) = delete;
+				Arena& operator=(const Arena&) = delete;
+				~Arena();
+				void* allocate(size_t size, size_t alignment);
+				string_view copy(string_view text);
+				template<typename T, typename... Args> T* make(Args&&... args);
+				void clear();
+		};
+
+		// Another name of a Param, in the registry's arena.
+		struct Alias {
+			string_view name;
+			Param* param;
+			Alias* next; // the param's next alias
+		};
+
+		// FNV-1a, also of the tables StaticParser builds at compile time
+		constexpr size_t hashName(string_view key) {
+			size_t h = 14695981039346656037ull;
+			for (char c : key) {
+				h = (h ^ (unsigned char)c) * 1099511628211ull;
+			}
+			return h;
+		}
+
+		// Lookup of every option name and alias. Names are found in an open addressing hash table
+		// with keys viewing the names themselves, which grows with every registration.
+		// Ids and the prefix trie are rebuilt on first lookup after a registration.
+		// With prefixes there is also a compressed trie over them: the edges of a node are contiguous
+		// and labelled with views into the names, and every node knows the one param named through it,
+		// if only one is, so a unique prefix is resolved in O(key length).
+		class Index {
+			private:
+				struct Entry {
+					string_view key;
+					Param* param;
+				};
+				struct Node {
+					Param* param = nullptr; // named by the path to this node
+					Param* below = nullptr; // the only param named through this node, nullptr if several
+					uint32_t firstEdge = 0;
+					uint32_t edgeCount = 0;
+				};
+				struct Edge {
+					const char* label;
+					uint32_t length;
+					uint32_t child;
+				};
+				vector<Entry> table; // size is a power of 2, at most half full
+				size_t count = 0; // of names in table
+				vector<Node> nodes; // the root first, empty without prefixes
+				vector<Edge> edges;
+				bool built = false;
+				void place(const Entry& entry);
+				uint32_t add(const vector<Entry>& keys, size_t begin, size_t end, size_t depth);
+			public:
+				void invalidate() { built = false; }
+				void insert(string_view key, Param* param); // a name not in the table yet
+				void rehash(const vector<Param*>& params, const vector<Alias*>& aliases); // after names were removed
+				void build(const vector<Param*>& params, bool prefixes); // ids by position in params, and the trie
+				Param* find(string_view key) const;
+				// the param whose names alone start with key; ambiguous tells several apart from none
+				Param* findPrefix(string_view key, bool& ambiguous) const;
+				bool ready() const { return built; }
+		};
+
+		// Owns every registered Param: the objects and their strings live in the arena,
+		// params stays in registration order, argdetails() renders them sorted by longPhrase, and index serves lookups.
+		class Registry {
+			public:
+				Arena arena;
+				vector<Param*> params;
+				vector<Alias*> aliases;
+				Index index;
+				bool prefixes = false; // unique prefixes of names are accepted, see Parser::allowPrefixes
+				size_t generation = 0; // changes with every registration, for caches of derived data
+				bool replaces = true; // registering a taken name replaces that option, else it is an error
+				mutable vector<Param*> ordered; // params by longPhrase, sorted again for a render after a registration
+				mutable size_t orderedGeneration = SIZE_MAX;
+				void add(Param* param);
+				Param* add(TYPE _type, const Ops* _ops, bool _list, void* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase);
+				Param* addUntyped(TYPE _type, void* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase);
+				template<typename T> Param* addTyped(T* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase);
+				void alias(Param* param, string_view name); // exits if another option has the name
+				void drop(const vector<Param*>& dropped); // unregisters these, their storage stays in the arena until clear()
+				void restore(const vector<Param*>& dropped); // registers these again with their aliases, exits if a name is taken
+				void clear();
+				void prepare(); // builds the index if a registration changed it
+				const vector<Param*>& byName() const; // params in the order of argdetails()
+				Param* find(string_view name) const { return index.find(name); }
+				Param* findPrefix(string_view name, bool& ambiguous) const { return index.findPrefix(name, ambiguous); }
+		};
+
+		// A file mapped read-only into memory (read into a buffer where mmap is not available).
+		// A stream such as stdin is read a chunk at a time instead, see refill().
+		class MappedFile {
+			private:
+				const char* data = nullptr;
+				size_t length = 0;
+				size_t dropped = 0; // bytes at the front already handed back to the kernel
+#if !PARAMS_HAVE_MMAP
+				string contents; // of the file, read whole
+#endif
+				FILE* stream = nullptr;
+				string chunk; // of the stream: what is still needed and what was read after it
+			public:
+				MappedFile() = default;
+				MappedFile(const MappedFile&) = delete;
+				MappedFile& operator=(const MappedFile&) = delete;
+				~MappedFile() { close(); }
+				bool open(const char* path);
+				void close();
+				const char* begin() const { return data; }
+				const char* end() const { return data+length; }
+				void consumed(const char* position); // nothing before position is needed any more
+				bool openStream(FILE* input); // reads nothing yet, the data is empty until refill()
+				bool streaming() const { return stream != nullptr; }
+				// of a stream: drops the data before keep, which moves to begin(), and reads more after the rest;
+				// false at the end of the stream
+				bool refill(const char* keep);
+		};
+
+		// Threads for the pieces of the rounds of a parallel list, see convertSpans. They are started by the
+		// first round which needs them, wait for the next round, and are joined with the Workers, once per parse.
+		// Their state lives in the implementation, so that only it needs the threading headers.
+		class Workers {
+			private:
+				struct Pool;
+				unique_ptr<Pool> pool;
+			public:
+				Workers() = default;
+				Workers(const Workers&) = delete;
+				Workers& operator=(const Workers&) = delete;
+				~Workers();
+				static unsigned cores(); // at least 1
+				// work(p) for each p below count, work(0) on this thread; returns once all of them returned
+				void run(size_t count, const function<void(size_t)>& work);
 		};
 
-		static map<string, Param*> params_map;
+		// Walks argv in place and yields tokens as views into the argv strings themselves.
+		// Tokens are separated by spaces, by unescaped '=' and by the argv entry boundaries.
+		// A token starting with '"' runs to the next '"', and only a quoted token spanning
+		// several argv entries needs to be copied (joined by single spaces into spill).
+		// An unquoted token "@path" is replaced by the tokens of that response file, which is mapped
+		// and tokenized in place by the same rules, with newlines and tabs also separating.
+		// "@-" reads stdin that way a chunk at a time, and a token cut by the chunk end is moved along.
+		// A config file is tokenized like a response file, and lines starting with '#' are comments.
+		// There the values of an option end with its line: startsLine() tells the parser to stop.
+		// A token is valid until the next call to next().
+		class Tokenizer {
+			private:
+				char** entry; // current argv entry
+				const char* cursor; // read position inside the current range
+				const char* limit; // end of the current range, either *entry or the response file
+				const char* rangeBegin;
+				bool inFile = false;
+				bool fileOpened = false;
+				bool lastQuoted = false;
+				bool comments = false; // a line starting with '#' is skipped, in config files
+				bool lastLineStart = false;
+				const char* lastBegin = nullptr;
+				MappedFile file;
+				Workers workers; // of the parallel lists
+				const char* resume[3]; // argv range to continue with after the response file
+				string spill;
+				string failedPath; // response file which could not be read
+				vector<Span> spans; // argv entries handed to a bulk converter together
+				size_t gatherBytes = 2*parallelPiece; // of argv entries to gather, doubled after they all converted
+				PARAMS_STAT(size_t scanned = 0; size_t allocations = 0;)
+				bool isSeparator(const char* c) const;
+				void setRange(const char* begin, const char* end);
+				bool nextRange();
+				bool openFile(string_view path);
+				bool refill(const char* keep); // more of a streamed response file, keeping keep and what follows
+				void gatherEntries(); // spans of the current and the following argv entries, about gatherBytes of them
+				bool atLineStart(const char* c) const;
+			public:
+				Tokenizer(char** _argv);
+				explicit Tokenizer(string_view config); // text of a config file: response file rules and '#' comments
+				bool next(string_view& token);
+				size_t remaining() const; // estimate of the tokens left, for reserving
+				// hands the input from the current position to a bulk converter, one range at a time,
+				// until it leaves a token for next(); returns the number of values it took.
+				// With threads other than 1 the converter gets many argv entries at once, to spread them over threads.
+				size_t bulk(size_t (*convert)(void*, Span*, size_t, size_t&, bool, char, unsigned, Workers&, const Constraint*), void* destination, char delimiter, unsigned threads, const Constraint* constraint);
+				bool quoted() const { return lastQuoted; } // the last token was a quoted string
+				bool startsLine() const { return lastLineStart; } // the last token began a line of a config file
+				void unread() { cursor = lastBegin; } // of a token which startsLine, to read it again
+				bool enteredFile(); // true once after a response file was opened
+				bool failed() const { return !failedPath.empty(); }
+				string_view failure() const { return failedPath; }
+				PARAMS_STAT(void collect(Stats& stats) const { stats.bytes += scanned; stats.allocations += allocations; })
+		};
+
+		// How a parse ended. For a failure, param, token (its position in the input) and text tell where.
+		struct Outcome {
+			Failure failure = Failure::NONE;
+			const Param* param = nullptr;
+			size_t token = 0;
+			string_view text; // valid as long as the Tokenizer
+			bool help = false; // --help was given and nothing after it was read
+		};
+
+		// Parse state of one Param. The destination is the bound variable, or a value owned by a Result.
+		struct Slot {
+			const Param* param;
+			void* destination;
+			int xargsRead; // how many of the required arguments have been set by the user
+			bool set; // if required then should be set by end of argparse (we check)
+			unsigned source = 0; // which of the Sources last gave the option, 0 for none yet
+			size_t kept = 0; // values a list held before the parse, for a later source to go back to
+		};
+
+		// The parsing shared by argparse, Schema and StaticParser: values go to slots[param->id].destination.
+		// Names looks the options up, a Registry or StaticNames: find(), findPrefix() and prefixes.
+		// An option already given by an earlier source is started over, see Sources. Tokens are counted from first,
+		// for a parse which goes on after an unknown token, see parseSources.
+		template<typename Names> Outcome parseTokens(const Names& names, Tokenizer& tokens, Slot* slots, Stats& stats, unsigned source=1, size_t first=0);
+		// required options check and default fill of fixed count lists, after all tokens are read
+		PARAMS_API Outcome finishParse(Slot* slots, size_t count, Stats& stats);
+		// both of the above, with the stats of this parse
+		template<typename Names> Outcome parseAll(const Names& names, Tokenizer& tokens, Slot* slots, size_t count, Stats& stats);
+		// the same over all the Sources, with the text of a failure copied to failedText; the first argv token which
+		// is neither an option nor a value is handed to command, which may register the options of a command by
+		// that name (and add their slots) and return true for the parse to go on after it
+		PARAMS_API Outcome parseSources(const Registry& registry, const Sources& sources, vector<Slot>& slots, Stats& stats, string& failedText, const function<bool(string_view)>& command=nullptr);
+		PARAMS_API string describe(const Outcome& outcome);
+		// the message of a value of the option name which a Lazy did not convert
+		PARAMS_API string lazyFailure(TYPE type, string_view name, const Constraint* constraint, errc result, string_view text);
+		// conversion failure of a token, and the values of a token stored to a slot, at most of them
+		PARAMS_API Outcome valueFailure(errc result, const Param* param, size_t position, string_view token);
+		PARAMS_API Outcome assignValues(const Param* param, Slot& slot, string_view token, bool quoted, size_t most, size_t& position, size_t& taken);
 
-		Param::Param(TYPE _type, void* _destination, string _longPhrase, string _helpPhrase, int _xargs, bool _required, string _defaultValue) : type(_type), destination(_destination), longPhrase(_longPhrase), helpPhrase(_helpPhrase), xargs(_xargs), xargsRead(0), required(_required), defaultValue(_defaultValue) {
+		constexpr Param::Param(TYPE _type, const Ops* _ops, bool _list, void* _destination, string_view _longPhrase, string_view _helpPhrase, int _xargs, bool _required, string_view _defaultValue) : type(_type), ops(_ops), destination(_destination), longPhrase(_longPhrase), helpPhrase(_helpPhrase), xargs(_xargs), required(_required), list(_list), defaultValue(_defaultValue), id(0), delimiter(0), threads(1), constraint(nullptr), aliases(nullptr) {
 			if (type == TYPE::BOOL) {
-				set = true;
 				required = false;
-				if (defaultValue != "") {
-					Set(defaultValue);
-				} else {
-					Set("false");
+			}
+		}
+
+		template<typename T, typename... Args> T* Arena::make(Args&&... args) {
+			T* object = new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+			if constexpr (!is_trivially_destructible<T>::value) {
+				finalizers.push_back(Finalizer{[](void* o) { static_cast<T*>(o)->~T(); }, object});
+			}
+			return object;
+		}
+
+#if PARAMS_DEFINE
+		PARAMS_API Arena::~Arena() {
+			clear();
+			free(head);
+		}
+
+		PARAMS_API void* Arena::allocate(size_t size, size_t alignment) {
+			if (head != nullptr) { // the address is aligned, the block header need not be
+				uintptr_t start = reinterpret_cast<uintptr_t>(head+1);
+				size_t offset = size_t(((start + head->used + alignment-1) & ~uintptr_t(alignment-1)) - start);
+				if (offset+size <= head->size) {
+					head->used = offset+size;
+					return reinterpret_cast<char*>(head+1) + offset;
+				}
+			}
+			size_t blockSize = (head != nullptr) ? head->size*2 : 4096;
+			while (blockSize < size+alignment-1) { // room for the worst padding
+				blockSize *= 2;
+			}
+			Block* block = static_cast<Block*>(malloc(sizeof(Block)+blockSize));
+			if (block == nullptr) {
+				fprintf(stderr, "Out of memory while registering options.\n");
+				exit(1);
+			}
+			*block = Block{head, blockSize, 0};
+			head = block;
+			return allocate(size, alignment);
+		}
+
+		PARAMS_API string_view Arena::copy(string_view text) {
+			if (text.empty()) {
+				return string_view();
+			}
+			char* storage = static_cast<char*>(allocate(text.size(), 1));
+			memcpy(storage, text.data(), text.size());
+			return string_view(storage, text.size());
+		}
+
+		PARAMS_API void Arena::clear() {
+			for (auto i = finalizers.rbegin(); i != finalizers.rend(); ++i) {
+				i->destroy(i->object);
+			}
+			finalizers.clear();
+			if (head == nullptr) {
+				return;
+			}
+			while (head->previous != nullptr) {
+				Block* previous = head->previous->previous;
+				free(head->previous);
+				head->previous = previous;
+			}
+			head->used = 0;
+		}
+
+		PARAMS_API void Index::place(const Entry& entry) {
+			size_t slot = hashName(entry.key) & (table.size()-1);
+			while (table[slot].param != nullptr) {
+				slot = (slot+1) & (table.size()-1);
+			}
+			table[slot] = entry;
+		}
+
+		PARAMS_API void Index::insert(string_view key, Param* param) {
+			if ((count+1)*2 > table.size()) {
+				vector<Entry> old(max(table.size()*2, size_t(8)), Entry{string_view(), nullptr});
+				old.swap(table);
+				for (const Entry& entry : old) {
+					if (entry.param != nullptr) {
+						place(entry);
+					}
+				}
+			}
+			place(Entry{key, param});
+			++count;
+		}
+
+		PARAMS_API void Index::rehash(const vector<Param*>& params, const vector<Alias*>& aliases) {
+			table.clear();
+			count = 0;
+			for (Param* param : params) {
+				insert(param->longPhrase, param);
+			}
+			for (Alias* alias : aliases) {
+				insert(alias->name, alias->param);
+			}
+		}
+
+		PARAMS_API void Index::build(const vector<Param*>& params, bool prefixes) {
+			for (size_t i=0; i<params.size(); ++i) {
+				params[i]->id = i;
+			}
+			nodes.clear();
+			edges.clear();
+			if (prefixes) {
+				vector<Entry> keys;
+				keys.reserve(count);
+				for (const Entry& entry : table) {
+					if (entry.param != nullptr) {
+						keys.push_back(entry);
+					}
+				}
+				sort(keys.begin(), keys.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+				add(keys, 0, keys.size(), 0);
+			}
+			built = true;
+		}
+
+		// the trie node for keys[begin, end), which share their first depth characters
+		PARAMS_API uint32_t Index::add(const vector<Entry>& keys, size_t begin, size_t end, size_t depth) {
+			uint32_t index = uint32_t(nodes.size());
+			nodes.push_back(Node());
+			Param* below = (begin < end) ? keys[begin].param : nullptr;
+			for (size_t i=begin; i<end && below != nullptr; ++i) {
+				below = (keys[i].param == below) ? below : nullptr;
+			}
+			nodes[index].below = below;
+			if (begin < end && keys[begin].key.size() == depth) { // sorted first
+				nodes[index].param = keys[begin].param;
+				++begin;
+			}
+			auto groupEnd = [&](size_t i) {
+				size_t j = i+1;
+				while (j < end && keys[j].key[depth] == keys[i].key[depth]) {
+					++j;
+				}
+				return j;
+			};
+			uint32_t count = 0;
+			for (size_t i=begin; i<end; i=groupEnd(i)) {
+				++count;
+			}
+			uint32_t first = uint32_t(edges.size());
+			edges.resize(first+count);
+			nodes[index].firstEdge = first;
+			nodes[index].edgeCount = count;
+			for (size_t i=begin, e=first; i<end; ++e) {
+				size_t j = groupEnd(i);
+				string_view low = keys[i].key, high = keys[j-1].key; // sorted, so their common prefix is the group's
+				size_t common = depth+1;
+				while (common < low.size() && common < high.size() && low[common] == high[common]) {
+					++common;
+				}
+				edges[e].label = low.data()+depth;
+				edges[e].length = uint32_t(common-depth);
+				uint32_t child = add(keys, i, j, common);
+				edges[e].child = child;
+				i = j;
+			}
+			return index;
+		}
+
+		PARAMS_API Param* Index::find(string_view key) const {
+			if (table.empty())
+				return nullptr;
+			size_t mask = table.size()-1;
+			for (size_t slot = hashName(key) & mask; table[slot].param != nullptr; slot = (slot+1) & mask) {
+				if (table[slot].key == key) {
+					return table[slot].param;
+				}
+			}
+			return nullptr;
+		}
+
+		PARAMS_API Param* Index::findPrefix(string_view key, bool& ambiguous) const {
+			ambiguous = false;
+			if (nodes.empty() || key.find_first_not_of('-') == string_view::npos)
+				return nullptr; // dashes alone are no prefix
+			const Node* node = nodes.data();
+			while (!key.empty()) {
+				const Edge* edge = nullptr;
+				for (uint32_t e=node->firstEdge; e<node->firstEdge+node->edgeCount && edge == nullptr; ++e) {
+					edge = (edges[e].label[0] == key[0]) ? &edges[e] : nullptr;
 				}
+				if (edge == nullptr)
+					return nullptr;
+				size_t length = min(size_t(edge->length), key.size()); // key may end inside the label
+				if (key.compare(0, length, string_view(edge->label, length)) != 0)
+					return nullptr;
+				key.remove_prefix(length);
+				node = &nodes[edge->child];
+			}
+			if (node->param != nullptr)
+				return node->param;
+			ambiguous = (node->below == nullptr);
+			return node->below;
+		}
+
+		PARAMS_API bool paramBefore(const Param* a, const Param* b) {
+			return a->longPhrase < b->longPhrase;
+		}
+
+		PARAMS_API void Registry::add(Param* param) {
+			Param* owner = index.find(param->longPhrase);
+			if (owner != nullptr && owner->longPhrase != param->longPhrase) {
+				fprintf(stderr, "Option '%.*s' cannot be registered, it is an alias of '%.*s'.\n", int(param->longPhrase.size()), param->longPhrase.data(), int(owner->longPhrase.size()), owner->longPhrase.data());
+				exit(1);
+			}
+			if (owner != nullptr && !replaces) {
+				fprintf(stderr, "Option '%.*s' is already registered, a command cannot register it again.\n", int(param->longPhrase.size()), param->longPhrase.data());
+				exit(1);
+			}
+			if (owner != nullptr) { // re-registration replaces, the old one is released with the arena
+				*find_if(params.begin(), params.end(), [&](const Param* p) { return p == owner; }) = param;
+				aliases.erase(remove_if(aliases.begin(), aliases.end(), [&](const Alias* alias) { return alias->param == owner; }), aliases.end());
+				index.rehash(params, aliases);
 			} else {
-				if (xargs == 1) {
-					Set(defaultValue);
+				params.push_back(param);
+				index.insert(param->longPhrase, param);
+			}
+			index.invalidate();
+			++generation;
+		}
+
+		PARAMS_API void Registry::alias(Param* param, string_view name) {
+			const Param* owner = index.find(name);
+			if (name.empty() || owner != nullptr) {
+				string_view taken = (owner != nullptr) ? owner->longPhrase : string_view("");
+				fprintf(stderr, "Option '%.*s' cannot take the alias '%.*s', it names '%.*s'.\n", int(param->longPhrase.size()), param->longPhrase.data(), int(name.size()), name.data(), int(taken.size()), taken.data());
+				exit(1);
+			}
+			Alias* alias = arena.make<Alias>(Alias{arena.copy(name), param, nullptr});
+			aliases.push_back(alias);
+			index.insert(alias->name, param);
+			Alias** last = &param->aliases;
+			while (*last != nullptr) {
+				last = &(*last)->next;
+			}
+			*last = alias;
+			index.invalidate();
+			++generation;
+		}
+
+		PARAMS_API void Registry::drop(const vector<Param*>& dropped) {
+			vector<Param*> sorted = dropped;
+			sort(sorted.begin(), sorted.end());
+			auto isDropped = [&](const Param* param) { return binary_search(sorted.begin(), sorted.end(), param); };
+			params.erase(remove_if(params.begin(), params.end(), isDropped), params.end());
+			aliases.erase(remove_if(aliases.begin(), aliases.end(), [&](const Alias* alias) { return isDropped(alias->param); }), aliases.end());
+			index.rehash(params, aliases);
+			index.invalidate();
+			++generation;
+		}
+
+		PARAMS_API void Registry::restore(const vector<Param*>& dropped) {
+			auto take = [&](Param* param, string_view name) {
+				const Param* owner = index.find(name);
+				if (owner != nullptr) {
+					fprintf(stderr, "Option '%.*s' cannot be registered again, '%.*s' names '%.*s' now.\n", int(param->longPhrase.size()), param->longPhrase.data(), int(name.size()), name.data(), int(owner->longPhrase.size()), owner->longPhrase.data());
+					exit(1);
+				}
+				index.insert(name, param);
+			};
+			for (Param* param : dropped) {
+				take(param, param->longPhrase);
+				for (Alias* alias = param->aliases; alias != nullptr; alias = alias->next) {
+					take(param, alias->name);
+					aliases.push_back(alias);
 				}
-			} 
+				params.push_back(param);
+			}
+			index.invalidate();
+			++generation;
 		}
 
-		void Param::Set(string value) {
-			if (value == "")
+		PARAMS_API void Registry::clear() {
+			params.clear();
+			aliases.clear();
+			index.rehash(params, aliases);
+			index.invalidate();
+			++generation;
+			arena.clear();
+		}
+
+		PARAMS_API void Registry::prepare() {
+			if (!index.ready()) {
+				index.build(params, prefixes);
+			}
+		}
+
+		PARAMS_API const vector<Param*>& Registry::byName() const {
+			if (orderedGeneration != generation) {
+				ordered = params;
+				sort(ordered.begin(), ordered.end(), paramBefore);
+				orderedGeneration = generation;
+			}
+			return ordered;
+		}
+
+#if PARAMS_HAVE_MMAP
+		PARAMS_API bool MappedFile::open(const char* path) {
+			close();
+			int descriptor = ::open(path, O_RDONLY);
+			if (descriptor < 0)
+				return false;
+			struct stat info;
+			if (fstat(descriptor, &info) != 0) {
+				::close(descriptor);
+				return false;
+			}
+			length = size_t(info.st_size);
+			if (length > 0) {
+				void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+				if (mapping == MAP_FAILED) {
+					::close(descriptor);
+					length = 0;
+					return false;
+				}
+				madvise(mapping, length, MADV_SEQUENTIAL);
+				data = static_cast<const char*>(mapping);
+			} else {
+				data = "";
+			}
+			::close(descriptor);
+			return true;
+		}
+
+		PARAMS_API void MappedFile::close() {
+			if (stream != nullptr) {
+				stream = nullptr;
+				chunk = string();
+			} else if (length > 0) {
+				munmap(const_cast<char*>(data), length);
+			}
+			data = nullptr;
+			length = 0;
+			dropped = 0;
+		}
+
+		PARAMS_API void MappedFile::consumed(const char* position) {
+			// give pages back in large steps, so huge files are read with bounded resident memory
+			const size_t step = size_t(64) << 20;
+			if (length == 0 || stream != nullptr)
+				return; // nothing mapped: a config text from memory, or a stream which is refilled in place
+			size_t offset = size_t(position-data);
+			if (offset-dropped < step)
 				return;
-			switch(type) {
-				case TYPE::BOOL: {
-										  bool* variable = static_cast<bool*>(destination);
-										  string lowercase="";
-										  for (auto ch : value) { lowercase.push_back( char(tolower(ch)) ); }
-										  if (lowercase != "false" && lowercase != "true") {
-											  fprintf(stderr, "Unrecognized default value for boolean option: '%s'\n", value.c_str());
-											  exit(1);
-										  }
-										  if (lowercase == "true") {
-											  *variable = true;
-										  } else if (lowercase == "false") {
-											  *variable = false;
-										  }
-									  }
-									  break;
-				case TYPE::INT: {
-										 if (xargs == 1) {
-											 int* variable = static_cast<int*>(destination);
-											 *variable = stoi(value);
-										 } else {
-											 vector<int>* variable = static_cast<vector<int>*>(destination);
-											 try {
-											 variable->push_back(stoi(value));
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type INT): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-										 }
-									 }
-									 break;
-				case TYPE::FLOAT: {
-											if (xargs == 1) {
-												float* variable = static_cast<float*>(destination);
-												*variable = stof(value);
-											} else {
-												vector<float>* variable = static_cast<vector<float>*>(destination);
-												try {
-												variable->push_back(stof(value));
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type FLOAT): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-											}
-										}
-										break;
-				case TYPE::DOUBLE: {
-										 if (xargs == 1) {
-											 double* variable = static_cast<double*>(destination);
-											 *variable = stod(value);
-										 } else {
-											 vector<double>* variable = static_cast<vector<double>*>(destination);
-											 try {
-											 variable->push_back(stod(value));
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type DOUBLE): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-										 }
-										 }
-										 break;
-				case TYPE::UINT: {
-										 if (xargs == 1) {
-											 unsigned int* variable = static_cast<unsigned int*>(destination);
-											 *variable = stoul(value);
-										 } else {
-											 vector<unsigned int>* variable = static_cast<vector<unsigned int>*>(destination);
-											 try {
-											 variable->push_back(stoul(value));
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type UINT): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-										 }
-									  }
-									  break;
-				case TYPE::LONG: {
-										 if (xargs == 1) {
-											 long* variable = static_cast<long*>(destination);
-											 *variable = stol(value);
-										 } else {
-											 vector<long>* variable = static_cast<vector<long>*>(destination);
-											 try {
-											 variable->push_back(stol(value));
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type LONG): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-										 }
-									  }
-									  break;
-				case TYPE::CHAR: {
-										 if (xargs == 1) {
-											 char* variable = static_cast<char*>(destination);
-											 *variable = value[0];
-										 } else {
-											 vector<char>* variable = static_cast<vector<char>*>(destination);
-											 try {
-											 variable->push_back(value[0]);
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type CHAR): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-										 }
-									  }
-									  break;
-				case TYPE::STRING: {
-											 if (xargs == 1) {
-												 string* variable = static_cast<string*>(destination);
-												 *variable = value;
-											 } else {
-												 vector<string>* variable = static_cast<vector<string>*>(destination);
-												 try {
-												 variable->push_back(value);
-											 } catch ( ... ) {
-												 fprintf(stderr, "Error in argument (expected type STRING): %s\n", value.c_str());
-												 fprintf(stderr, "Options which expect infinite arguments should be last.\n");
-												 exit(1);
-											 }
-											 }
-										 }
-										 break;
-				default:
-										 perror("(Warning! Unknown argument type.)\t");
-										 break;
-			}
-		}
-	}
-
-	static void addp(TYPE _type, void* _destination) { // for the help flag
-		priv::Param* addedparam = new priv::Param(_type, _destination, "--help", "Prints this help message.", 1, false);
-		priv::params_map["--help"] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, 1, true);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, int _xargs, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, _xargs, true);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-	
-	static void addp(TYPE _type, void* _destination, string _defaultValue, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, 1, false, _defaultValue);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, int _xargs, string _defaultValue, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, _xargs, false, _defaultValue);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, bool _required, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, 1, _required);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, int _xargs, bool _required, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, _xargs, _required);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-	
-	static void addp(TYPE _type, void* _destination, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, 1, _required, _defaultValue);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void addp(TYPE _type, void* _destination, int _xargs, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
-		priv::Param* addedparam = new priv::Param(_type, _destination, _longPhrase, _helpPhrase, _xargs, _required, _defaultValue);
-		priv::params_map[_longPhrase] = addedparam;
-	}
-
-	static void argparse(char** argv) {
-		string args = ""; // all args as string
-		vector<int> pos; // word positions [start, end, start, end, start, ...]
-		for (int i=1; argv[i]!=nullptr; ++i) {
-			args += string(argv[i])+" ";
-		}
-		int posspace=0, posquote=0, posequals=0;
-		posequals=args.find('=', 0);
-		while(posequals != -1) {
-			if (posequals > 0 && args[posequals-1] != '\\') {
-				args[posequals] = ' ';
-			}
-			posequals = args.find('=', posequals+1);
-		}
-		int location = 0;
-		posspace = args.find_first_not_of(' ', location); // get new word boundary start
-		while(posspace != -1 && (unsigned long)posspace != args.length()-1) {
-			if (args[posspace] == '"') { // if new word is string, then find end of string (not \", but ")
-				pos.push_back(posspace+1); // skip the quotation mark
-				posquote = posspace;
-				location=posquote;
-				posquote = args.find('"', location+1); // find end of string 
-				location = posquote;
-				pos.push_back(location);
-			} else { // else new word is not a string, find end space boundary after recording beginning
-				location = posspace;
-				pos.push_back(location);
-				posspace = args.find(' ', location+1);
-				location = posspace;
-				pos.push_back(location);
-			}
-			posspace = args.find_first_not_of(' ', location+1); // get new word boundary start
-		}
-		bool readingAnOption = true; // indicates if the read loop is trying to read a switch or argument
-		priv::Param* parameter = nullptr; // parameter for which we're reading a value(s)
-		int parameter_counter=1;
-		for (auto i=begin(pos); i!=end(pos); ++i) {
-			if (readingAnOption) {
-				int beg=*i++;
-				string key = args.substr(beg, *i-beg);
-				if (priv::params_map.find(key) == priv::params_map.end()) {
-					fprintf(stderr, "Unrecognized option '%s' in invocation.", key.c_str());
-					exit(1);
-				} else {
-					parameter = priv::params_map[key];
-					if (parameter->type != TYPE::BOOL) {
-						readingAnOption = false;
-						parameter_counter = parameter->xargs;
-					} else {
-						parameter->Set("true");
-						if (key == "--help") {
-							return;
+			size_t page = size_t(sysconf(_SC_PAGESIZE));
+			size_t until = offset & ~(page-1);
+			madvise(const_cast<char*>(data)+dropped, until-dropped, MADV_DONTNEED);
+			dropped = until;
+		}
+#else
+		PARAMS_API bool MappedFile::open(const char* path) {
+			close();
+			stream = fopen(path, "rb");
+			if (stream == nullptr)
+				return false;
+			char buffer[65536];
+			size_t count;
+			while ((count = fread(buffer, 1, sizeof(buffer), stream)) > 0) {
+				contents.append(buffer, count);
+			}
+			bool good = !ferror(stream);
+			fclose(stream);
+			stream = nullptr; // read whole, not streamed
+			data = contents.data();
+			length = contents.size();
+			return good;
+		}
+
+		PARAMS_API void MappedFile::close() {
+			contents = string();
+			stream = nullptr;
+			chunk = string();
+			data = nullptr;
+			length = 0;
+			dropped = 0;
+		}
+
+		PARAMS_API void MappedFile::consumed(const char*) {
+		}
+#endif
+
+		PARAMS_API bool MappedFile::openStream(FILE* input) {
+			close();
+			stream = input;
+			data = "";
+			return true;
+		}
+
+		PARAMS_API bool MappedFile::refill(const char* keep) {
+			const size_t step = size_t(1) << 20;
+			if (stream == nullptr)
+				return false;
+			int next = getc(stream); // known before anything moves
+			if (next == EOF || ungetc(next, stream) == EOF)
+				return false;
+			size_t kept = size_t(data+length-keep);
+			if (kept != 0) {
+				memmove(&chunk[0], keep, kept);
+			}
+			if (chunk.size() < kept+step) { // grows only for a token longer than a chunk
+				chunk.resize(kept+step);
+			}
+			size_t count = fread(&chunk[kept], 1, chunk.size()-kept, stream);
+			data = chunk.data();
+			length = kept+count;
+			return count > 0;
+		}
+
+		// Thread i runs piece i of each round which has one for it, and the last to finish wakes run().
+		struct Workers::Pool {
+			vector<thread> threads;
+			mutex lock;
+			condition_variable start, done;
+			const function<void(size_t)>* work = nullptr;
+			size_t round = 0; // counts the rounds handed out
+			size_t count = 0; // pieces of the current round
+			size_t pending = 0; // of those, still running on the threads
+			bool stopping = false;
+			void serve(size_t index, size_t seen) {
+				unique_lock<mutex> held(lock);
+				while (true) {
+					start.wait(held, [&]() { return stopping || round != seen; });
+					if (stopping)
+						return;
+					seen = round;
+					if (index < count) {
+						held.unlock();
+						(*work)(index);
+						held.lock();
+						if (--pending == 0) {
+							done.notify_one();
 						}
 					}
 				}
-			} else { // reading an argument
-				int beg=*i++;
-				string key = args.substr(beg, *i-beg);
-				parameter->Set(key);
-            ++parameter->xargsRead;
-				--parameter_counter;
-				if (parameter_counter == 0) {
-					parameter->set = true;
-					readingAnOption = true;
-				} else if (parameter_counter < 0) {
-					parameter->set = true; // we will never stop reading arguments, as we assume infinite args in this case
+			}
+		};
+
+		PARAMS_API Workers::~Workers() {
+			if (pool == nullptr)
+				return;
+			{
+				lock_guard<mutex> held(pool->lock);
+				pool->stopping = true;
+			}
+			pool->start.notify_all();
+			for (thread& worker : pool->threads) {
+				worker.join();
+			}
+		}
+
+		PARAMS_API unsigned Workers::cores() {
+			return max(1u, thread::hardware_concurrency());
+		}
+
+		PARAMS_API void Workers::run(size_t count, const function<void(size_t)>& work) {
+			if (count > 1) {
+				if (pool == nullptr) {
+					pool = make_unique<Pool>();
+				}
+				{
+					lock_guard<mutex> held(pool->lock);
+					while (pool->threads.size() < count-1) { // more pieces than any round before
+						pool->threads.emplace_back(&Pool::serve, pool.get(), pool->threads.size()+1, pool->round);
+					}
+					pool->work = &work;
+					pool->count = count;
+					pool->pending = count-1;
+					++pool->round;
 				}
+				pool->start.notify_all();
+			}
+			work(0);
+			if (count > 1) {
+				unique_lock<mutex> held(pool->lock);
+				pool->done.wait(held, [&]() { return pool->pending == 0; });
 			}
 		}
-		for (auto& entry : priv::params_map) {
-			if (entry.second->required && !entry.second->set) {
-				fprintf(stderr, "Option '%s' required, and not found, or incomplete.\n", entry.second->longPhrase.c_str());
-				exit(1);
+
+		PARAMS_API Tokenizer::Tokenizer(char** _argv) : entry(_argv), cursor(nullptr), limit(nullptr), rangeBegin(nullptr) {
+			if (*entry != nullptr) { // skip program name
+				++entry;
 			}
-         if (entry.second->xargs > 1) {
-            for (int i=entry.second->xargs-entry.second->xargsRead-1; i>=0; --i) {
-               entry.second->Set( entry.second->defaultValue );
-            }
-         }
-		}
-	}
-
-	static string argdetails() {
-		string details="";
-		for (auto& entry : priv::params_map) {
-			details += "\t"+entry.second->longPhrase;
-			details += "\n\t\t"+entry.second->helpPhrase;
-			if (entry.second->xargs > 0 && entry.second->type != TYPE::BOOL) {
-				details += "\n\t\t"+to_string(entry.second->xargs)+" argument";
-				details += (entry.second->xargs != 1) ? "s" : "" ;
-				details += " of type ";
-				switch(entry.second->type) {
-					case TYPE::BOOL: 
-						details += "bool.";
-						break;
-					case TYPE::INT: 
-						details += "int.";
-						break;
-					case TYPE::FLOAT: 
-						details += "float.";
-						break;
-					case TYPE::DOUBLE: 
-						details += "double.";
-						break;
-					case TYPE::UINT: 
-						details += "unsigned int.";
-						break;
-					case TYPE::LONG: 
-						details += "long.";
-						break;
-					case TYPE::CHAR: 
-						details += "char.";
-						break;
-					case TYPE::STRING: 
-						details += "string.";
+			if (*entry != nullptr) {
+				setRange(*entry, *entry+strlen(*entry));
+			}
+		}
+
+		PARAMS_API Tokenizer::Tokenizer(string_view config) : cursor(nullptr), limit(nullptr), rangeBegin(nullptr), inFile(true), comments(true), resume{nullptr, nullptr, nullptr} {
+			static char* none[] = {nullptr};
+			entry = none; // no argv to continue with
+			setRange(config.data(), config.data()+config.size());
+		}
+
+		PARAMS_API bool Tokenizer::isSeparator(const char* c) const {
+			return *c == ' ' || (*c == '=' && (c == rangeBegin || c[-1] != '\\')) || (inFile && (*c == '\n' || *c == '\t' || *c == '\r'));
+		}
+
+		PARAMS_API void Tokenizer::setRange(const char* begin, const char* end) {
+			rangeBegin = cursor = begin;
+			limit = end;
+			PARAMS_STAT(scanned += size_t(end-begin);)
+		}
+
+		PARAMS_API bool Tokenizer::nextRange() {
+			if (inFile) { // back to the rest of the argv entry which named the file
+				file.close();
+				inFile = false;
+				rangeBegin = resume[0];
+				cursor = resume[1];
+				limit = resume[2];
+				return true;
+			}
+			if (*entry == nullptr || *++entry == nullptr)
+				return false;
+			setRange(*entry, *entry+strlen(*entry));
+			return true;
+		}
+
+		PARAMS_API bool Tokenizer::atLineStart(const char* c) const {
+			while (c != rangeBegin && (c[-1] == ' ' || c[-1] == '\t' || c[-1] == '\r')) {
+				--c;
+			}
+			return c == rangeBegin || c[-1] == '\n';
+		}
+
+		PARAMS_API bool Tokenizer::openFile(string_view path) {
+			string name(path);
+			PARAMS_STAT(++allocations;)
+			if (!((name == "-") ? file.openStream(stdin) : file.open(name.c_str()))) {
+				failedPath = name;
+				return false;
+			}
+			inFile = true;
+			fileOpened = true;
+			resume[0] = rangeBegin;
+			resume[1] = cursor;
+			resume[2] = limit;
+			setRange(file.begin(), file.end());
+			return true;
+		}
+
+		PARAMS_API bool Tokenizer::refill(const char* keep) {
+			if (!inFile || !file.streaming())
+				return false;
+			const char* from = (keep != rangeBegin) ? keep-1 : keep; // for the escape check of isSeparator
+			size_t offset = size_t(cursor-from);
+			PARAMS_STAT(size_t kept = size_t(limit-from);)
+			if (!file.refill(from))
+				return false;
+			rangeBegin = file.begin();
+			cursor = rangeBegin+offset;
+			limit = file.end();
+			PARAMS_STAT(scanned += size_t(limit-rangeBegin)-kept;)
+			return true;
+		}
+
+		PARAMS_API size_t Tokenizer::remaining() const {
+			size_t count = 0;
+			if (*entry == nullptr && !inFile)
+				return count;
+			for (char** later = entry+1; *entry != nullptr && *later != nullptr; ++later) {
+				++count;
+			}
+			if (inFile) { // about one value per line
+				for (const char* line = cursor; line != nullptr && line != limit; ++count) {
+					line = static_cast<const char*>(memchr(line, '\n', size_t(limit-line)));
+					if (line == nullptr)
 						break;
+					++line;
 				}
 			}
-			//printf("Reauired '%s'\n", (entry.second->required ? "true" : "false"));
-			if (entry.second->required == false) {
-				details += "\n\t\tdefault: '"+entry.second->defaultValue+"'";
+			return count+1;
+		}
+
+		PARAMS_API void Tokenizer::gatherEntries() {
+			size_t bytes = size_t(limit-cursor);
+			spans.assign(1, Span{cursor, limit});
+			for (char** later = entry+1; *entry != nullptr && *later != nullptr && bytes < gatherBytes && spans.size() < (size_t(1) << 20); ++later) {
+				size_t length = strlen(*later);
+				spans.push_back(Span{*later, *later+length});
+				bytes += length;
+			}
+		}
+
+		PARAMS_API size_t Tokenizer::bulk(size_t (*convert)(void*, Span*, size_t, size_t&, bool, char, unsigned, Workers&, const Constraint*), void* destination, char delimiter, unsigned threads, const Constraint* constraint) {
+			size_t count = 0, stopped = 0;
+			while (true) { // range after range, until a token needs next()
+				if (!inFile && threads != 1) { // many argv entries at once
+					gatherEntries();
+					count += convert(destination, spans.data(), spans.size(), stopped, false, delimiter, threads, workers, constraint);
+					PARAMS_STAT(for (size_t i=1; i<min(stopped+1, spans.size()); ++i) { scanned += size_t(spans[i].end-entry[i]); })
+					if (stopped < spans.size()) { // left in entry+stopped, whose span begin was moved
+						size_t progress = size_t(spans[stopped].begin-((stopped == 0) ? cursor : entry[stopped]));
+						for (size_t i=0; i<stopped; ++i) {
+							progress += size_t(spans[i].end-((i == 0) ? cursor : entry[i]));
+						}
+						gatherBytes = max(size_t(64), 2*progress); // what is gathered past a stop again is at most twice the progress
+						entry += stopped;
+						rangeBegin = *entry;
+						cursor = spans[stopped].begin;
+						limit = spans[stopped].end;
+						return count;
+					}
+					gatherBytes *= 2;
+					entry += spans.size()-1;
+					rangeBegin = *entry;
+					cursor = limit = spans.back().end;
+				} else {
+					if (!inFile && size_t(limit-cursor) < 64)
+						return count; // a short argv entry, next() is quicker
+					if (cursor != limit) {
+						if (inFile) {
+							file.consumed(cursor);
+						}
+						Span span{cursor, limit};
+						if (file.streaming()) { // up to the last separator, a token cut by the chunk end is read after refill
+							while (span.end != cursor && span.end[-1] != ' ' && span.end[-1] != '\n' && span.end[-1] != '\t' && span.end[-1] != '\r' && span.end[-1] != delimiter) {
+								--span.end;
+							}
+						}
+						const char* end = span.end;
+						count += convert(destination, &span, 1, stopped, inFile && !comments, delimiter, threads, workers, constraint); // newlines end a config line's values
+						cursor = (stopped == 0) ? span.begin : end;
+						if (cursor != end)
+							return count;
+					}
+				}
+				if (refill(cursor))
+					continue;
+				if (file.streaming() && cursor != limit)
+					return count; // the last token of the stream, for next()
+				if (!nextRange())
+					return count;
 			}
-			details += "\n";
 		}
-		return details;
-	}
-}
 
+		PARAMS_API bool Tokenizer::enteredFile() {
+			bool opened = fileOpened;
+			fileOpened = false;
+			return opened;
+		}
+
+		PARAMS_API bool Tokenizer::next(string_view& token) {
+			lastQuoted = false;
+			lastLineStart = false;
+			while (true) {
+				while (cursor != limit && isSeparator(cursor)) {
+					++cursor;
+				}
+				if (cursor == limit) { // range exhausted
+					if (!refill(cursor) && !nextRange())
+						return false;
+					continue;
+				}
+				if (inFile) {
+					file.consumed(cursor);
+				}
+				if (comments && *cursor == '#' && atLineStart(cursor)) {
+					const char* line = static_cast<const char*>(memchr(cursor, '\n', size_t(limit-cursor)));
+					cursor = (line != nullptr) ? line : limit;
+					continue;
+				}
+				lastBegin = cursor;
+				lastLineStart = comments && atLineStart(cursor);
+				if (*cursor == '"') { // quoted string runs to the next quotation mark
+					lastQuoted = true;
+					const char* begin = cursor+1;
+					const char* close = static_cast<const char*>(memchr(begin, '"', size_t(limit-begin)));
+					if (close != nullptr) {
+						token = string_view(begin, size_t(close-begin));
+						cursor = close+1;
+						return true;
+					}
+					if (refill(cursor))
+						continue; // read again with more of the stream
+					if (inFile) { // unterminated string takes the rest of the file
+						token = string_view(begin, size_t(limit-begin));
+						cursor = limit;
+						return true;
+					}
+					PARAMS_STAT(size_t spillCapacity = spill.capacity();)
+					spill.assign(begin, limit);
+					for (++entry; *entry != nullptr; ++entry) {
+						spill += ' ';
+						close = strchr(*entry, '"');
+						if (close != nullptr) {
+							spill.append(*entry, size_t(close-*entry));
+							PARAMS_STAT(allocations += (spill.capacity() != spillCapacity);)
+							setRange(*entry, *entry+strlen(*entry));
+							cursor = close+1;
+							token = spill;
+							return true;
+						}
+						spill += *entry;
+					}
+					PARAMS_STAT(allocations += (spill.capacity() != spillCapacity);)
+					--entry; // unterminated string takes the rest of the input
+					cursor = limit = nullptr;
+					token = spill;
+					return true;
+				}
+				const char* end = cursor+1;
+				while (end != limit && !isSeparator(end)) {
+					++end;
+				}
+				if (end == limit && refill(cursor))
+					continue; // the token may go on in the next chunk
+				token = string_view(cursor, size_t(end-cursor));
+				cursor = end;
+				if (!inFile && token.size() > 1 && token[0] == '@') { // response file, not nested
+					if (!openFile(token.substr(1)))
+						return false;
+					continue;
+				}
+				return true;
+			}
+		}
+
+#endif
+
+		template<typename T> errc convert(string_view text, T& value) {
+			if (!text.empty() && text[0] == '+') { // from_chars does not take a plus sign
+				text.remove_prefix(1);
+			}
+			const char* last = text.data()+text.size();
+			from_chars_result result;
+			if constexpr (is_floating_point<T>::value) {
+				result = from_chars(text.data(), last, value, chars_format::general);
+			} else {
+				result = from_chars(text.data(), last, value, 10);
+			}
+			if (result.ec == errc() && (result.ptr != last || text.empty())) {
+				return errc::invalid_argument;
+			}
+			return result.ec;
+		}
+
+		inline bool equalsNoCase(string_view text, string_view lowercase) {
+			if (text.size() != lowercase.size())
+				return false;
+			for (size_t i=0; i<text.size(); ++i) {
+				if (char(tolower(text[i])) != lowercase[i])
+					return false;
+			}
+			return true;
+		}
+
+		template<typename T> errc parseValue(string_view value, T& variable) {
+			return convert(value, variable);
+		}
+
+		inline errc parseValue(string_view value, bool& variable) {
+			if (equalsNoCase(value, "true")) {
+				variable = true;
+			} else if (equalsNoCase(value, "false")) {
+				variable = false;
+			} else {
+				return errc::invalid_argument;
+			}
+			return errc();
+		}
+
+		inline errc parseValue(string_view value, char& variable) {
+			variable = value[0];
+			return errc();
+		}
+
+		inline errc parseValue(string_view value, string& variable) {
+			variable = value;
+			return errc();
+		}
+
+		inline errc parseValue(string_view value, string_view& variable) { // of a Sink, valid during its call
+			variable = value;
+			return errc();
+		}
+
+		template<typename T> bool admits(const Constraint* constraint, const T& value) {
+			if (constraint == nullptr)
+				return true;
+			if constexpr (is_same<T,string>::value || is_same<T,string_view>::value) {
+				string_view text = value;
+				if (!constraint->choices.empty() && find(constraint->choices.begin(), constraint->choices.end(), text) == constraint->choices.end())
+					return false;
+				return !constraint->predicate || constraint->predicate(&text);
+			} else {
+				if constexpr (is_same<T,char>::value) {
+					if (!constraint->choices.empty() && find(constraint->choices.begin(), constraint->choices.end(), string_view(&value, 1)) == constraint->choices.end())
+						return false;
+				} else if constexpr (is_integral<T>::value && !is_same<T,bool>::value) {
+					if (constraint->bounded && !((long long)value >= constraint->lowInteger && (long long)value <= constraint->highInteger))
+						return false;
+				} else if constexpr (!is_same<T,bool>::value) {
+					if (constraint->bounded && !(double(value) >= constraint->low && double(value) <= constraint->high))
+						return false;
+				}
+				return !constraint->predicate || constraint->predicate(&value);
+			}
+		}
+
+		// parseValue, then the constraint, if any
+		template<typename T> errc parseAllowed(string_view value, T& variable, const Constraint* constraint) {
+			errc result = parseValue(value, variable);
+			if (result == errc() && !admits(constraint, variable))
+				return errc::argument_out_of_domain;
+			return result;
+		}
+
+		// Bulk conversion of numeric lists.
+		// A contiguous range (a response file or one argv entry holding many values) is classified
+		// a window at a time into bitmaps of separators and of characters needing the Tokenizer
+		// ('"' and '\\'). The option's delimiter counts as a separator too. The plain tokens in between
+		// are converted straight into the vector, simple decimals by a fast path and everything else
+		// by convert(). The first token which is not plain or does not convert is left to the Tokenizer
+		// and Param semantics, with the cursor on the separator (possibly the delimiter) before it.
+		typedef void (*Classifier)(const char* text, size_t length, bool inFile, char delimiter, uint64_t* separators, uint64_t* specials);
+		static const size_t bulkWindow = 4096; // bytes classified at once, 64 bitmap words
+
+		inline void markByte(const char* text, size_t i, bool inFile, char delimiter, uint64_t* separators, uint64_t* specials) {
+			char c = text[i];
+			if (c == ' ' || c == '=' || c == delimiter || (inFile && (c == '\n' || c == '\t' || c == '\r'))) {
+				separators[i/64] |= uint64_t(1) << (i%64);
+			} else if (c == '"' || c == '\\') {
+				specials[i/64] |= uint64_t(1) << (i%64);
+			}
+		}
+
+		// the bits from length up to the end of its word count as separators, so the last token ends there
+		inline void clearBitmaps(size_t length, uint64_t* separators, uint64_t* specials) {
+			size_t words = (length+63)/64;
+			for (size_t w=0; w<words; ++w) {
+				separators[w] = specials[w] = 0;
+			}
+			if (length%64 != 0) {
+				separators[length/64] = ~uint64_t(0) << (length%64);
+			}
+		}
+
+		// delimiter is 0 if the option has none, a delimiter of ' ' then stands in for it in the SIMD kernels
+		inline void classifyScalar(const char* text, size_t length, bool inFile, char delimiter, uint64_t* separators, uint64_t* specials) {
+			clearBitmaps(length, separators, specials);
+			if (delimiter == 0) {
+				delimiter = ' ';
+			}
+			for (size_t i=0; i<length; ++i) {
+				markByte(text, i, inFile, delimiter, separators, specials);
+			}
+		}
+
+#if PARAMS_HAVE_X86_SIMD
+		__attribute__((target("avx2"))) inline void classifyAVX2(const char* text, size_t length, bool inFile, char delimiter, uint64_t* separators, uint64_t* specials) {
+			clearBitmaps(length, separators, specials);
+			const __m256i space = _mm256_set1_epi8(' '), equals = _mm256_set1_epi8('='), quote = _mm256_set1_epi8('"'), backslash = _mm256_set1_epi8('\\');
+			const __m256i newline = _mm256_set1_epi8('\n'), tab = _mm256_set1_epi8('\t'), carriage = _mm256_set1_epi8('\r');
+			if (delimiter == 0) {
+				delimiter = ' ';
+			}
+			const __m256i separate = _mm256_set1_epi8(delimiter);
+			size_t i = 0;
+			for (; i+32 <= length; i += 32) {
+				__m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text+i));
+				__m256i separator = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, space), _mm256_cmpeq_epi8(chunk, equals)), _mm256_cmpeq_epi8(chunk, separate));
+				if (inFile) {
+					separator = _mm256_or_si256(separator, _mm256_or_si256(_mm256_cmpeq_epi8(chunk, newline), _mm256_or_si256(_mm256_cmpeq_epi8(chunk, tab), _mm256_cmpeq_epi8(chunk, carriage))));
+				}
+				__m256i special = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+				separators[i/64] |= uint64_t(uint32_t(_mm256_movemask_epi8(separator))) << (i%64);
+				specials[i/64] |= uint64_t(uint32_t(_mm256_movemask_epi8(special))) << (i%64);
+			}
+			for (; i<length; ++i) {
+				markByte(text, i, inFile, delimiter, separators, specials);
+			}
+		}
+
+		__attribute__((target("sse4.2"))) inline void classifySSE42(const char* text, size_t length, bool inFile, char delimiter, uint64_t* separators, uint64_t* specials) {
+			clearBitmaps(length, separators, specials);
+			if (delimiter == 0) {
+				delimiter = ' ';
+			}
+			const __m128i separatorSet = _mm_setr_epi8(' ', '=', delimiter, '\n', '\t', '\r', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+			const __m128i specialSet = _mm_setr_epi8('"', '\\', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+			const int separatorCount = inFile ? 6 : 3;
+			size_t i = 0;
+			for (; i+16 <= length; i += 16) {
+				__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text+i));
+				__m128i separator = _mm_cmpestrm(separatorSet, separatorCount, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+				__m128i special = _mm_cmpestrm(specialSet, 2, chunk, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK);
+				separators[i/64] |= uint64_t(uint16_t(_mm_cvtsi128_si32(separator))) << (i%64);
+				specials[i/64] |= uint64_t(uint16_t(_mm_cvtsi128_si32(special))) << (i%64);
+			}
+			for (; i<length; ++i) {
+				markByte(text, i, inFile, delimiter, separators, specials);
+			}
+		}
+#endif
+
+		inline Classifier chooseClassifier() {
+#if PARAMS_HAVE_X86_SIMD
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx2"))
+				return &classifyAVX2;
+			if (__builtin_cpu_supports("sse4.2"))
+				return &classifySSE42;
+#endif
+			return &classifyScalar;
+		}
+
+		inline size_t lowestBit(uint64_t word) {
+#if defined(__GNUC__)
+			return size_t(__builtin_ctzll(word));
+#else
+			size_t bit = 0;
+			for (; (word & 1) == 0; word >>= 1) {
+				++bit;
+			}
+			return bit;
+#endif
+		}
+
+		// position of the first bit equal to value in [from, length), or length
+		inline size_t findBit(const uint64_t* bits, size_t from, size_t length, bool value) {
+			while (from < length) {
+				uint64_t word = value ? bits[from/64] : ~bits[from/64];
+				word &= ~uint64_t(0) << (from%64);
+				if (word != 0)
+					return min(length, from/64*64 + lowestBit(word));
+				from = from/64*64 + 64;
+			}
+			return length;
+		}
+
+		// Up to 8 digits at once from a little endian word (text+8 must be readable). The token is
+		// shifted to the top of the word and the bottom filled with '0's, then the digits are
+		// checked and combined pairwise by multiplication.
+		inline bool eightDigits(const char* text, size_t length, uint64_t& value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+			uint64_t chunk;
+			memcpy(&chunk, text, 8);
+			const uint64_t zeros = 0x3030303030303030;
+			if (length < 8) {
+				chunk = (chunk << (8*(8-length))) | (zeros >> (8*length));
+			}
+			if (((chunk & 0xF0F0F0F0F0F0F0F0) | (((chunk + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) != 0x3333333333333333)
+				return false;
+			chunk -= zeros;
+			chunk = (chunk*10) + (chunk >> 8);
+			value = (((chunk & 0x000000FF000000FF) * (100 + (uint64_t(1000000) << 32))) + (((chunk >> 16) & 0x000000FF000000FF) * (1 + (uint64_t(10000) << 32)))) >> 32;
+			return true;
+#else
+			(void)text; (void)length; (void)value;
+			return false;
+#endif
+		}
+
+		// [+-]digits without overflow, anything else is left to convert(); readable ends the buffer
+		template<typename T> bool fastInteger(const char* text, const char* end, const char* readable, T& value) {
+			bool negative = (*text == '-');
+			if (*text == '-' || *text == '+') {
+				++text;
+			}
+			if (text == end || end-text > 18 || (negative && is_unsigned<T>::value))
+				return false;
+			uint64_t magnitude = 0;
+			if (end-text <= 8 && readable-text >= 8) {
+				if (!eightDigits(text, size_t(end-text), magnitude))
+					return false;
+			} else {
+				for (; text != end; ++text) {
+					unsigned digit = unsigned(*text-'0');
+					if (digit > 9)
+						return false;
+					magnitude = magnitude*10 + digit;
+				}
+			}
+			if (negative) {
+				if (magnitude > uint64_t(numeric_limits<T>::max())+1)
+					return false;
+				value = T(-int64_t(magnitude));
+			} else {
+				if (magnitude > uint64_t(numeric_limits<T>::max()))
+					return false;
+				value = T(magnitude);
+			}
+			return true;
+		}
+
+		// [+-]digits[.digits] whose mantissa and power of ten are exact in T, so one division rounds correctly
+		template<typename T> bool fastFloat(const char* text, const char* end, T& value) {
+#if FLT_EVAL_METHOD == 0
+			static const T powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+			const uint64_t maxMantissa = is_same<T,float>::value ? (uint64_t(1) << 24) : (uint64_t(1) << 53);
+			const size_t maxPower = is_same<T,float>::value ? 10 : 22;
+			bool negative = (*text == '-');
+			if (*text == '-' || *text == '+') {
+				++text;
+			}
+			uint64_t mantissa = 0;
+			size_t digits = 0, fraction = 0;
+			bool point = false;
+			for (; text != end; ++text) {
+				if (*text == '.' && !point) {
+					point = true;
+					continue;
+				}
+				unsigned digit = unsigned(*text-'0');
+				if (digit > 9 || ++digits > 19)
+					return false;
+				mantissa = mantissa*10 + digit;
+				fraction += point;
+			}
+			if (digits == 0 || mantissa > maxMantissa || fraction > maxPower)
+				return false;
+			value = T(mantissa) / powers[fraction];
+			if (negative) {
+				value = -value;
+			}
+			return true;
+#else
+			(void)text; (void)end; (void)value;
+			return false;
+#endif
+		}
+
+		// one plain token, false if it has to go through the Tokenizer and Param semantics instead
+		template<typename T> bool plainValue(const char* text, const char* end, const char* readable, T& value) {
+			if constexpr (is_floating_point<T>::value) {
+				return fastFloat(text, end, value) || convert(string_view(text, size_t(end-text)), value) == errc();
+			} else {
+				return fastInteger(text, end, readable, value) || convert(string_view(text, size_t(end-text)), value) == errc();
+			}
+		}
+
+		// checked is constraint != nullptr, so that options without one do not test it per value
+		template<bool checked, typename T> size_t bulkConvertChecked(vector<T>& values, const char*& cursor, const char* limit, bool inFile, char delimiter, const Constraint* constraint) {
+			static const Classifier classify = chooseClassifier();
+			uint64_t separators[bulkWindow/64], specials[bulkWindow/64];
+			size_t count = 0;
+			while (cursor != limit) {
+				const char* base = cursor;
+				size_t length = min(size_t(limit-base), bulkWindow);
+				size_t words = (length+63)/64;
+				classify(base, length, inFile, delimiter, separators, specials);
+				uint64_t special = 0;
+				for (size_t w=0; w<words; ++w) {
+					special |= specials[w];
+				}
+				// Tokens start at a non separator after a separator and end at a separator after
+				// a non separator, so the two masks alternate and can be paired in order.
+				uint64_t before = 1; // cursor is at the start of a range or just after a token
+				size_t begin = 0;
+				bool open = false;
+				for (size_t w=0; w<words; ++w) {
+					uint64_t following = (separators[w] << 1) | before;
+					before = separators[w] >> 63;
+					uint64_t starts = ~separators[w] & following, ends = separators[w] & ~following;
+					while (true) {
+						if (!open) {
+							if (starts == 0)
+								break;
+							begin = w*64 + lowestBit(starts);
+							starts &= starts-1;
+							open = true;
+						}
+						if (ends == 0)
+							break;
+						size_t end = w*64 + lowestBit(ends);
+						ends &= ends-1;
+						open = false;
+						T value;
+						if ((special != 0 && findBit(specials, begin, end, true) != end) || !plainValue(base+begin, base+end, limit, value) || (checked && !admits(constraint, value)))
+							return count;
+						values.push_back(value);
+						++count;
+						cursor = base+end;
+					}
+				}
+				if (!open) {
+					cursor = base+length;
+				} else if (base+length == limit) { // a token right up to the end of the input
+					T value;
+					if ((special != 0 && findBit(specials, begin, length, true) != length) || !plainValue(base+begin, limit, limit, value) || (checked && !admits(constraint, value)))
+						return count;
+					values.push_back(value);
+					++count;
+					cursor = limit;
+				} else if (begin == 0) {
+					return count; // longer than a window, not a plain value
+				} else {
+					cursor = base+begin-1; // the token goes on in the next window, which starts at the separator before it
+				}
+			}
+			return count;
+		}
+
+		template<typename T> size_t bulkConvert(vector<T>& values, const char*& cursor, const char* limit, bool inFile, char delimiter, const Constraint* constraint) {
+			if (constraint != nullptr)
+				return bulkConvertChecked<true>(values, cursor, limit, inFile, delimiter, constraint);
+			return bulkConvertChecked<false>(values, cursor, limit, inFile, delimiter, constraint);
+		}
+
+		inline bool bulkSeparator(char c, bool inFile, char delimiter) {
+			return c == ' ' || c == '=' || c == delimiter || (inFile && (c == '\n' || c == '\t' || c == '\r'));
+		}
+
+		// bulkConvert over the spans in order, up to the first which it does not convert to its end.
+		// Given threads, the input goes in rounds, cut at separators so that no token is split: the first
+		// round is converted on this thread, and each one which converted to its end doubles the next, which
+		// is cut into pieces of at least parallelPiece bytes which the workers convert at the same time, the first straight
+		// into values and the others into vectors of their own. These are appended in order up to the first
+		// piece which stopped early, so the values and where the conversion stopped are those of one thread,
+		// and so is the position of a bad token, which the Tokenizer finds from there. Input converted past
+		// such a stop is thrown away, at most twice what was converted before it.
+		template<typename T> size_t convertSpans(vector<T>& values, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned threads, Workers& workers, const Constraint* constraint) {
+			size_t converted = 0;
+			if (threads == 0) {
+				threads = Workers::cores();
+			}
+			if (threads == 1) {
+				for (stopped=0; stopped<count; ++stopped) {
+					converted += bulkConvert(values, spans[stopped].begin, spans[stopped].end, inFile, delimiter, constraint);
+					if (spans[stopped].begin != spans[stopped].end)
+						break;
+				}
+				return converted;
+			}
+			struct Part { // of a span, in a piece
+				size_t span;
+				Span input;
+			};
+			struct Piece {
+				vector<T> values;
+				size_t converted;
+				size_t part; // which stopped early, SIZE_MAX for none
+				const char* cursor;
+			};
+			vector<Part> parts;
+			vector<size_t> firsts; // first part of each piece, and the end of the last
+			vector<Piece> pieces;
+			size_t next = 0, budget = parallelPiece; // the input of the next round starts at spans[next].begin
+			while (next < count) {
+				size_t most = min(size_t(threads), budget/parallelPiece), share = budget/most;
+				parts.clear();
+				firsts.assign(1, 0);
+				while (firsts.size() <= most && next < count) { // a piece of share bytes
+					for (size_t taken = 0; taken < share && next < count; ) {
+						const char* begin = spans[next].begin;
+						const char* end = spans[next].end;
+						if (size_t(end-begin) > share-taken) {
+							end = begin+(share-taken);
+							while (end != spans[next].end && !bulkSeparator(*end, inFile, delimiter)) {
+								++end;
+							}
+						}
+						parts.push_back(Part{next, Span{begin, end}});
+						taken += size_t(end-begin);
+						spans[next].begin = end;
+						next += (end == spans[next].end);
+					}
+					firsts.push_back(parts.size());
+				}
+				pieces.assign(firsts.size()-1, Piece{vector<T>(), 0, SIZE_MAX, nullptr});
+				auto work = [&](size_t p) {
+					Piece& piece = pieces[p];
+					vector<T>& into = (p == 0) ? values : piece.values;
+					for (size_t k=firsts[p]; k<firsts[p+1]; ++k) {
+						const char* cursor = parts[k].input.begin;
+						piece.converted += bulkConvert(into, cursor, parts[k].input.end, inFile, delimiter, constraint);
+						if (cursor != parts[k].input.end) {
+							piece.part = k;
+							piece.cursor = cursor;
+							return;
+						}
+					}
+				};
+				workers.run(pieces.size(), work);
+				for (size_t p=0; p<pieces.size(); ++p) {
+					converted += pieces[p].converted;
+					if (p > 0) {
+						values.insert(values.end(), pieces[p].values.begin(), pieces[p].values.end());
+					}
+					if (pieces[p].part != SIZE_MAX) {
+						stopped = parts[pieces[p].part].span;
+						spans[stopped].begin = pieces[p].cursor;
+						return converted;
+					}
+				}
+				budget *= 2;
+			}
+			stopped = count;
+			return converted;
+		}
+
+		template<typename T> errc Binding<T>::assign(void* destination, size_t, string_view value, const Constraint* constraint) {
+			return parseAllowed(value, *static_cast<T*>(destination), constraint);
+		}
+
+		template<typename T> errc Binding<vector<T>>::assign(void* destination, size_t, string_view value, const Constraint* constraint) {
+			T converted;
+			errc result = parseAllowed(value, converted, constraint);
+			if (result == errc()) {
+				static_cast<vector<T>*>(destination)->push_back(move(converted));
+			}
+			return result;
+		}
+
+		template<typename T> void Binding<vector<T>>::reserve(void* destination, size_t count) {
+			vector<T>* variable = static_cast<vector<T>*>(destination);
+			if (variable->size()+count > variable->capacity()) { // grows at least geometrically, for repeated calls
+				variable->reserve(max(variable->size()+count, 2*variable->capacity()));
+			}
+		}
+
+		template<typename T> errc Binding<vector<T>>::fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint) {
+			T converted;
+			errc result = parseAllowed(value, converted, constraint);
+			if (result == errc()) {
+				vector<T>* variable = static_cast<vector<T>*>(destination);
+				variable->insert(variable->end(), count, converted);
+			}
+			return result;
+		}
+
+		template<typename T> size_t Binding<vector<T>>::bulk(void* destination, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned threads, Workers& workers, const Constraint* constraint) {
+			if constexpr (numeric) {
+				vector<T>* variable = static_cast<vector<T>*>(destination);
+				if (delimiter != 0) { // the token estimate does not see delimited values
+					size_t values = 0;
+					for (size_t i=0; i<count; ++i) {
+						values += size_t(std::count(spans[i].begin, spans[i].end, delimiter)) + 1;
+					}
+					reserve(variable, values);
+				}
+				return convertSpans(*variable, spans, count, stopped, inFile, delimiter, threads, workers, constraint);
+			}
+			stopped = 0;
+			return 0;
+		}
+
+		template<typename T> void Binding<vector<T>>::commit(void* destination, void* staged) {
+			vector<T>* variable = static_cast<vector<T>*>(destination);
+			vector<T>* values = static_cast<vector<T>*>(staged);
+			if (variable->empty()) {
+				variable->swap(*values);
+			} else {
+				variable->insert(variable->end(), make_move_iterator(values->begin()), make_move_iterator(values->end()));
+			}
+		}
+
+		template<typename H> errc FixedBinding<H>::assign(void* destination, size_t index, string_view value, const Constraint* constraint) {
+			if (index >= Fixed<H>::size(destination))
+				return errc::result_out_of_range;
+			return parseAllowed(value, Fixed<H>::data(destination)[index], constraint);
+		}
+
+		template<typename H> errc FixedBinding<H>::fill(void* destination, size_t index, size_t count, string_view value, const Constraint* constraint) {
+			T converted;
+			errc result = parseAllowed(value, converted, constraint);
+			if (result == errc()) {
+				T* data = Fixed<H>::data(destination);
+				std::fill(data+index, data+min(index+count, Fixed<H>::size(destination)), converted);
+			}
+			return result;
+		}
+
+		template<typename H> void* FixedBinding<H>::stage(const void* destination) {
+			void* staged = create(destination);
+			copy(Fixed<H>::data(destination), Fixed<H>::data(destination)+Fixed<H>::size(destination), Fixed<H>::data(staged));
+			return staged;
+		}
+
+		template<typename H> void FixedBinding<H>::commit(void* destination, void* staged) {
+			T* values = Fixed<H>::data(staged);
+			move(values, values+Fixed<H>::size(staged), Fixed<H>::data(destination));
+		}
+
+		template<typename T> errc Binding<Sink<T>>::assign(void* destination, size_t, string_view value, const Constraint* constraint) {
+			T converted{};
+			errc result = parseAllowed(value, converted, constraint);
+			const Sink<T>& sink = *static_cast<const Sink<T>*>(destination);
+			if (result == errc() && sink.consume) {
+				sink.consume(converted);
+			}
+			return result;
+		}
+
+		template<typename T> errc Binding<Sink<T>>::fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint) {
+			T converted{};
+			errc result = parseAllowed(value, converted, constraint);
+			const Sink<T>& sink = *static_cast<const Sink<T>*>(destination);
+			for (size_t i=0; i<count && result == errc() && sink.consume; ++i) {
+				sink.consume(converted);
+			}
+			return result;
+		}
+
+		// converted a slice at a time, cut at a separator, so only a slice of values is held;
+		// always on this thread, the sink sees the values in order
+		template<typename T> size_t Binding<Sink<T>>::bulk(void* destination, Span* spans, size_t count, size_t& stopped, bool inFile, char delimiter, unsigned, Workers&, const Constraint* constraint) {
+			size_t converted = 0;
+			stopped = 0;
+			if constexpr (numeric) { // in Ops otherwise not at all
+				const size_t slice = size_t(64) << 10;
+				const Sink<T>& sink = *static_cast<const Sink<T>*>(destination);
+				vector<T> values;
+				for (; stopped<count; ++stopped) {
+					const char*& cursor = spans[stopped].begin;
+					const char* limit = spans[stopped].end;
+					while (cursor != limit) {
+						const char* cut = limit;
+						if (size_t(limit-cursor) > slice) {
+							cut = cursor+slice;
+							while (cut != cursor && !bulkSeparator(*cut, inFile, delimiter)) {
+								--cut;
+							}
+							cut = (cut != cursor) ? cut : limit;
+						}
+						values.clear();
+						converted += bulkConvert(values, cursor, cut, inFile, delimiter, constraint);
+						for (const T& value : values) {
+							if (sink.consume) {
+								sink.consume(value);
+							}
+						}
+						if (cursor != cut)
+							return converted; // a token for the Tokenizer
+					}
+				}
+			}
+			return converted;
+		}
+
+		template<typename T> void* Binding<Sink<T>>::stage(const void* destination) {
+			const Sink<T>* bound = static_cast<const Sink<T>*>(destination);
+			return new Sink<T>{[bound](const T& value) {
+				if (bound->consume) {
+					bound->consume(value);
+				}
+			}};
+		}
+
+		template<typename T> void Binding<Lazy<T>>::reserve(void* destination, size_t count) {
+			vector<size_t>& ends = static_cast<Lazy<T>*>(destination)->ends;
+			if (list && ends.size()+count > ends.capacity()) {
+				ends.reserve(max(ends.size()+count, 2*ends.capacity()));
+			}
+		}
+
+		// the text is kept for every copy, so the conversion later gives what the parse would have
+		template<typename T> errc Binding<Lazy<T>>::fill(void* destination, size_t, size_t count, string_view value, const Constraint* constraint) {
+			Lazy<T>& lazy = *static_cast<Lazy<T>*>(destination);
+			keepConstraint(lazy.constraint, constraint);
+			if (!list) { // given again, replaced
+				lazy.texts.clear();
+				lazy.ends.clear();
+				lazy.plain = true;
+				count = 1;
+			}
+			lazy.plain = lazy.plain && !value.empty() && value.find_first_of(" =\t\n\r") == string_view::npos;
+			for (size_t i=0; i<count; ++i) {
+				lazy.texts += value;
+				lazy.ends.push_back(lazy.texts.size());
+				lazy.texts += '\n';
+			}
+			lazy.converted = false;
+			return errc();
+		}
+
+		template<typename T> void* Binding<Lazy<T>>::stage(const void* destination) {
+			const Lazy<T>& bound = *static_cast<const Lazy<T>*>(destination);
+			if (!list)
+				return new Lazy<T>(bound);
+			Lazy<T>* staged = new Lazy<T>();
+			staged->name = bound.name;
+			return staged;
+		}
+
+		template<typename T> void Binding<Lazy<T>>::commit(void* destination, void* staged) {
+			Lazy<T>& lazy = *static_cast<Lazy<T>*>(destination);
+			Lazy<T>& values = *static_cast<Lazy<T>*>(staged);
+			if (!list || lazy.ends.empty()) {
+				swap(lazy, values);
+				return;
+			}
+			size_t offset = lazy.texts.size();
+			lazy.texts += values.texts;
+			for (size_t end : values.ends) {
+				lazy.ends.push_back(offset+end);
+			}
+			lazy.plain = lazy.plain && values.plain;
+			lazy.constraint = values.constraint;
+			lazy.converted = false;
+		}
+
+		template<typename T> void Binding<Lazy<T>>::truncate(void* destination, size_t count) {
+			Lazy<T>& lazy = *static_cast<Lazy<T>*>(destination);
+			if (list && count < lazy.ends.size()) {
+				lazy.texts.resize((count == 0) ? 0 : lazy.ends[count-1]+1);
+				lazy.ends.resize(count);
+				lazy.converted = false;
+			}
+		}
+
+		// Cache encoding of values: numbers, bool and char as their bytes, strings each after a 64 bit length.
+		// A single value needs no length, its record has one.
+		template<typename T> void encodeValues(const T* values, size_t count, string& out) {
+			if constexpr (is_same<T,string>::value) {
+				for (size_t i=0; i<count; ++i) {
+					uint64_t length = values[i].size();
+					out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+					out += values[i];
+				}
+			} else {
+				out.append(reinterpret_cast<const char*>(values), count*sizeof(T));
+			}
+		}
+
+		// the next string of an encoded list, false when bytes is malformed
+		inline bool decodeString(string_view& bytes, string_view& text) {
+			uint64_t length;
+			if (bytes.size() < sizeof(length))
+				return false;
+			memcpy(&length, bytes.data(), sizeof(length));
+			if (bytes.size()-sizeof(length) < length)
+				return false;
+			text = bytes.substr(sizeof(length), size_t(length));
+			bytes.remove_prefix(sizeof(length)+size_t(length));
+			return true;
+		}
+
+		template<typename T> void Binding<T>::save(const void* destination, size_t, string& out) {
+			if constexpr (is_same<T,string>::value) {
+				out += *static_cast<const string*>(destination);
+			} else {
+				encodeValues(static_cast<const T*>(destination), 1, out);
+			}
+		}
+
+		template<typename T> bool Binding<T>::load(void* destination, string_view bytes, bool write) {
+			if constexpr (is_same<T,string>::value) {
+				if (write) {
+					*static_cast<string*>(destination) = bytes;
+				}
+			} else {
+				if (bytes.size() != sizeof(T))
+					return false;
+				if (write) {
+					memcpy(destination, bytes.data(), sizeof(T));
+				}
+			}
+			return true;
+		}
+
+		template<typename T> void Binding<vector<T>>::save(const void* destination, size_t from, string& out) {
+			const vector<T>* values = static_cast<const vector<T>*>(destination);
+			encodeValues(values->data()+from, values->size()-from, out);
+		}
+
+		template<typename T> bool Binding<vector<T>>::load(void* destination, string_view bytes, bool write) {
+			vector<T>* values = static_cast<vector<T>*>(destination);
+			if constexpr (is_same<T,string>::value) {
+				string_view text;
+				while (!bytes.empty()) {
+					if (!decodeString(bytes, text))
+						return false;
+					if (write) {
+						values->emplace_back(text);
+					}
+				}
+			} else {
+				if (bytes.size() % sizeof(T) != 0)
+					return false;
+				if (write) {
+					size_t count = values->size();
+					values->resize(count + bytes.size()/sizeof(T));
+					memcpy(values->data()+count, bytes.data(), bytes.size());
+				}
+			}
+			return true;
+		}
+
+		template<typename H> void FixedBinding<H>::save(const void* destination, size_t, string& out) {
+			encodeValues(Fixed<H>::data(destination), Fixed<H>::size(destination), out);
+		}
+
+		template<typename H> bool FixedBinding<H>::load(void* destination, string_view bytes, bool write) {
+			T* values = Fixed<H>::data(destination);
+			size_t count = Fixed<H>::size(destination);
+			if constexpr (is_same<T,string>::value) {
+				string_view text;
+				for (size_t i=0; i<count; ++i) {
+					if (!decodeString(bytes, text))
+						return false;
+					if (write) {
+						values[i] = text;
+					}
+				}
+				return bytes.empty();
+			} else {
+				if (bytes.size() != count*sizeof(T))
+					return false;
+				if (write) {
+					memcpy(values, bytes.data(), bytes.size());
+				}
+				return true;
+			}
+		}
+
+		template<typename H> const Ops FixedBinding<H>::ops = {&assign, &reserve, &fill, &create, &destroy, &capacity, &stage, &commit, nullptr, &length, &truncate, &save, &load};
+		template<typename T> const Ops Binding<T>::ops = {&assign, &reserve, &fill, &create, &destroy, &capacity, &stage, &commit, nullptr, &length, &truncate, &save, &load};
+		template<typename T> const Ops Binding<vector<T>>::ops = {&assign, &reserve, &fill, &create, &destroy, &capacity, &stage, &commit, numeric ? &bulk : nullptr, &length, &truncate, &save, &load};
+		template<typename T> const Ops Binding<Sink<T>>::ops = {&assign, &reserve, &fill, &create, &destroy, &capacity, &stage, &commit, numeric ? &bulk : nullptr, &length, &truncate, nullptr, nullptr};
+		template<typename T> const Ops Binding<Lazy<T>>::ops = {&assign, &reserve, &fill, &create, &destroy, &capacity, &stage, &commit, nullptr, &length, &truncate, nullptr, nullptr};
+	}
+
+	// Plain numeric lists go through the bulk converter from where the last value stopped it, the others
+	// a value at a time, each as the parse would have converted it.
+	template<typename T> void Lazy<T>::convert() const {
+		const priv::Ops& ops = priv::Binding<T>::ops;
+		value = T();
+		result = errc();
+		ops.reserve(&value, ends.size());
+		for (size_t i=0; i<ends.size(); ++i) {
+			if (ops.bulk != nullptr && plain) {
+				size_t begin = (i == 0) ? 0 : ends[i-1]+1;
+				priv::Span span{texts.data()+begin, texts.data()+texts.size()};
+				size_t stopped;
+				priv::Workers none; // on this thread
+				i += ops.bulk(&value, &span, 1, stopped, true, 0, 1, none, constraint.get());
+				if (i == ends.size())
+					break;
+			}
+			result = ops.assign(&value, i, text(i), constraint.get());
+			if (result != errc()) {
+				failed = i;
+				break;
+			}
+		}
+		converted = true;
+	}
+
+	template<typename T> const T* Lazy<T>::tryGet() const {
+		if (!converted) {
+			convert();
+		}
+		return (result == errc()) ? &value : nullptr;
+	}
+
+	template<typename T> const T& Lazy<T>::get() const {
+		const T* values = tryGet();
+		if (values == nullptr) {
+			fprintf(stderr, "%s\n", error().c_str());
+			exit(1);
+		}
+		return *values;
+	}
+
+	template<typename T> string Lazy<T>::error() const {
+		if (tryGet() != nullptr)
+			return "";
+		return priv::lazyFailure(priv::Binding<T>::type, name, constraint.get(), result, text(failed));
+	}
+
+	namespace priv {
+
+#if PARAMS_DEFINE
+		// Ops for the untyped addp(TYPE, void*, ...) overloads, chosen once at registration
+		PARAMS_API const Ops* opsFor(TYPE type, int xargs) {
+			bool list = (xargs != 1);
+			switch(type) {
+				case TYPE::BOOL: return &Binding<bool>::ops; // flags never take a list
+				case TYPE::INT: return list ? &Binding<vector<int>>::ops : &Binding<int>::ops;
+				case TYPE::UINT: return list ? &Binding<vector<unsigned int>>::ops : &Binding<unsigned int>::ops;
+				case TYPE::FLOAT: return list ? &Binding<vector<float>>::ops : &Binding<float>::ops;
+				case TYPE::LONG: return list ? &Binding<vector<long>>::ops : &Binding<long>::ops;
+				case TYPE::DOUBLE: return list ? &Binding<vector<double>>::ops : &Binding<double>::ops;
+				case TYPE::CHAR: return list ? &Binding<vector<char>>::ops : &Binding<char>::ops;
+				case TYPE::STRING: return list ? &Binding<vector<string>>::ops : &Binding<string>::ops;
+			}
+			return nullptr;
+		}
+
+		PARAMS_API const char* typeName(TYPE type) {
+			switch(type) {
+				case TYPE::BOOL: return "BOOL";
+				case TYPE::INT: return "INT";
+				case TYPE::UINT: return "UINT";
+				case TYPE::FLOAT: return "FLOAT";
+				case TYPE::LONG: return "LONG";
+				case TYPE::DOUBLE: return "DOUBLE";
+				case TYPE::CHAR: return "CHAR";
+				case TYPE::STRING: return "STRING";
+			}
+			return "";
+		}
+
+		PARAMS_API void Param::Set(void* _destination, string_view value) const {
+			if (value == "")
+				return;
+			errc result = ops->assign(_destination, 0, value, constraint);
+			if (result != errc()) {
+				Outcome outcome;
+				outcome.failure = (result == errc::result_out_of_range) ? Failure::OUT_OF_RANGE
+						: (result == errc::argument_out_of_domain) ? Failure::NOT_ALLOWED : Failure::BAD_VALUE;
+				outcome.param = this;
+				outcome.text = value;
+				fprintf(stderr, "%s\n", describe(outcome).c_str());
+				exit(1);
+			}
+		}
+
+		PARAMS_API void Param::SetDefault(void* _destination) const {
+			if (type == TYPE::BOOL) {
+				Set(_destination, (defaultValue != "") ? defaultValue : "false");
+			} else if (!list) {
+				Set(_destination, defaultValue);
+			}
+		}
+
+		PARAMS_API Param* Registry::add(TYPE _type, const Ops* _ops, bool _list, void* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase) {
+			Param* param = arena.make<Param>(_type, _ops, _list, _destination, arena.copy(_longPhrase), arena.copy(_helpPhrase), _xargs, _required, arena.copy(_defaultValue));
+			add(param);
+			return param;
+		}
+
+		PARAMS_API Param* Registry::addUntyped(TYPE _type, void* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase) {
+			Param* param = add(_type, opsFor(_type, _xargs), _xargs != 1, _destination, _xargs, _required, _defaultValue, _longPhrase, _helpPhrase);
+			param->SetDefault(_destination);
+			return param;
+		}
+
+#endif
+
+		template<typename T> Param* Registry::addTyped(T* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase) {
+			static_assert(!is_same<T, vector<bool>>::value, "BOOL options are flags and bind to a bool.");
+			if (!Binding<T>::list && Binding<T>::type != TYPE::BOOL && _xargs != 1) {
+				fprintf(stderr, "Option '%.*s' takes %d arguments and must be bound to a vector.\n", int(_longPhrase.size()), _longPhrase.data(), _xargs);
+				exit(1);
+			}
+			if (Binding<T>::fixed) { // the count follows from the destination unless given
+				size_t size = Binding<T>::capacity(_destination);
+				if (_xargs == 1) {
+					_xargs = int(size);
+				}
+				if (_xargs < 0 || size_t(_xargs) > size) {
+					fprintf(stderr, "Option '%.*s' takes %d arguments, but its destination holds %zu.\n", int(_longPhrase.size()), _longPhrase.data(), _xargs, size);
+					exit(1);
+				}
+			}
+			Param* param = add(Binding<T>::type, &Binding<T>::ops, Binding<T>::list, _destination, _xargs, _required, _defaultValue, _longPhrase, _helpPhrase);
+			if constexpr (IsLazy<T>::value) {
+				Binding<T>::named(_destination, param->longPhrase);
+			}
+			param->SetDefault(_destination);
+			return param;
+		}
+
+#if PARAMS_DEFINE
+		PARAMS_API Outcome valueFailure(errc result, const Param* param, size_t position, string_view token) {
+			Outcome outcome;
+			outcome.failure = (result == errc::result_out_of_range) ? Failure::OUT_OF_RANGE
+					: (result == errc::argument_out_of_domain) ? Failure::NOT_ALLOWED : Failure::BAD_VALUE;
+			outcome.param = param;
+			outcome.token = position;
+			outcome.text = token;
+			return outcome;
+		}
+		// Assigns the values of one token and counts them in position. For an option with a delimiter
+		// the values of an unquoted token are its non-empty pieces, of which at most most are taken.
+		PARAMS_API Outcome assignValues(const Param* param, Slot& slot, string_view token, bool quoted, size_t most, size_t& position, size_t& taken) {
+			Outcome outcome;
+			taken = 0;
+			if (param->delimiter == 0 || quoted) {
+				++position;
+				if (token != "") {
+					errc result = param->ops->assign(slot.destination, size_t(slot.xargsRead), token, param->constraint);
+					if (result != errc())
+						return valueFailure(result, param, position, token);
+				}
+				taken = 1;
+				return outcome;
+			}
+			param->ops->reserve(slot.destination, size_t(count(token.begin(), token.end(), param->delimiter))+1);
+			while (!token.empty()) {
+				size_t cut = token.find(param->delimiter);
+				string_view piece = token.substr(0, cut);
+				token = (cut == string_view::npos) ? string_view() : token.substr(cut+1);
+				if (piece.empty())
+					continue;
+				++position;
+				if (taken == most) {
+					outcome.failure = Failure::TOO_MANY_VALUES;
+					outcome.param = param;
+					outcome.token = position;
+					outcome.text = piece;
+					return outcome;
+				}
+				errc result = param->ops->assign(slot.destination, size_t(slot.xargsRead)+taken, piece, param->constraint);
+				if (result != errc())
+					return valueFailure(result, param, position, piece);
+				++taken;
+			}
+			return outcome;
+		}
+
+
+#endif
+
+#ifdef PARAMS_STATS
+		class Stopwatch {
+			private:
+				chrono::steady_clock::time_point started = chrono::steady_clock::now();
+			public:
+				double lap() {
+					chrono::steady_clock::time_point now = chrono::steady_clock::now();
+					double seconds = chrono::duration<double>(now-started).count();
+					started = now;
+					return seconds;
+				}
+		};
+#endif
+
+		// "-vqx" for the short flags -v, -q and -x, true if every letter names a BOOL option and they were set
+		template<typename Names> bool setFlags(const Names& names, string_view token, Slot* slots, bool& help) {
+			if (token.size() < 3 || token[0] != '-' || token[1] == '-')
+				return false;
+			char name[2] = {'-', 0};
+			for (int pass=0; pass<2; ++pass) { // checked first, so nothing is set for an unknown token
+				for (size_t i=1; i<token.size(); ++i) {
+					name[1] = token[i];
+					const Param* flag = names.find(string_view(name, 2));
+					if (flag == nullptr || flag->type != TYPE::BOOL)
+						return false;
+					if (pass == 1) {
+						flag->ops->assign(slots[flag->id].destination, 0, "true", nullptr);
+						help = help || flag->longPhrase == "--help";
+					}
+				}
+			}
+			return true;
+		}
+
+		template<typename Names> Outcome parseTokens(const Names& names, Tokenizer& tokens, Slot* slots, [[maybe_unused]] Stats& stats, unsigned source, size_t first) {
+			Outcome outcome;
+			string_view token;
+			Slot* slot = nullptr; // parameter for which we're reading a value(s)
+			size_t position=first;
+			PARAMS_STAT(Stopwatch watch; size_t capacity = 0;)
+#define PARAMS_STAT_TOKEN() PARAMS_STAT(stats.tokenizeSeconds += watch.lap(); ++stats.tokens;)
+#define PARAMS_STAT_CONVERT(param, count) PARAMS_STAT(stats.convertSeconds += watch.lap(); stats.converted[int(param->type)] += count; \
+		if (param->ops->capacity(slot->destination) != capacity) { ++stats.allocations; capacity = param->ops->capacity(slot->destination); })
+			for (; tokens.next(token); ++position) {
+				PARAMS_STAT_TOKEN();
+				const Param* parameter = names.find(token);
+				bool ambiguous = false;
+				if (parameter == nullptr && names.prefixes) {
+					parameter = names.findPrefix(token, ambiguous);
+				}
+				PARAMS_STAT(stats.lookupSeconds += watch.lap(); ++stats.lookups;)
+				if (parameter == nullptr && !ambiguous && setFlags(names, token, slots, outcome.help)) {
+					PARAMS_STAT(stats.converted[int(TYPE::BOOL)] += token.size()-1;)
+					if (outcome.help)
+						return outcome;
+					continue;
+				}
+				if (parameter == nullptr) {
+					outcome.failure = ambiguous ? Failure::AMBIGUOUS_OPTION : Failure::UNKNOWN_OPTION;
+					outcome.token = position;
+					outcome.text = token;
+					return outcome;
+				}
+				slot = &slots[parameter->id];
+				if (slot->source != source) { // first time in this source
+					if (slot->source != 0 && parameter->type != TYPE::BOOL) {
+						parameter->ops->truncate(slot->destination, slot->kept);
+						slot->xargsRead = 0;
+						slot->set = false;
+					} else if (parameter->list) {
+						slot->kept = parameter->ops->length(slot->destination);
+					}
+					slot->source = source;
+				}
+				PARAMS_STAT(capacity = parameter->ops->capacity(slot->destination);)
+				if (parameter->type == TYPE::BOOL) {
+					parameter->ops->assign(slot->destination, 0, "true", nullptr);
+					PARAMS_STAT_CONVERT(parameter, 1);
+					if (parameter->longPhrase == "--help") {
+						outcome.help = true;
+						return outcome;
+					}
+					continue;
+				}
+				const Ops* ops = parameter->ops;
+				if (parameter->xargs < 0) { // infinite arguments: everything left is a value of this option
+					ops->reserve(slot->destination, tokens.remaining());
+					tokens.enteredFile();
+					while (true) {
+						if (ops->bulk != nullptr) { // plain numbers straight from the input
+							size_t count = tokens.bulk(ops->bulk, slot->destination, parameter->delimiter, parameter->threads, parameter->constraint);
+							position += count;
+							slot->xargsRead += int(count);
+							slot->set = slot->set || count > 0;
+							PARAMS_STAT(stats.tokens += count;)
+							PARAMS_STAT_CONVERT(parameter, count);
+						}
+						if (!tokens.next(token))
+							break;
+						PARAMS_STAT_TOKEN();
+						if (tokens.startsLine()) {
+							tokens.unread();
+							break;
+						}
+						size_t taken = 0;
+						outcome = assignValues(parameter, *slot, token, tokens.quoted(), SIZE_MAX, position, taken);
+						PARAMS_STAT_CONVERT(parameter, taken);
+						if (outcome.failure != Failure::NONE)
+							return outcome;
+						slot->xargsRead += int(taken);
+						slot->set = slot->set || taken > 0;
+						if (tokens.enteredFile()) {
+							ops->reserve(slot->destination, tokens.remaining());
+						}
+					}
+					if (!tokens.startsLine())
+						break; // the input ended
+					continue; // in a config file the line did
+				}
+				if (parameter->list) {
+					ops->reserve(slot->destination, size_t(parameter->xargs));
+				}
+				for (int parameter_counter = parameter->xargs; parameter_counter > 0 && tokens.next(token); ) {
+					PARAMS_STAT_TOKEN();
+					if (tokens.startsLine()) {
+						tokens.unread();
+						break;
+					}
+					size_t taken = 0;
+					outcome = assignValues(parameter, *slot, token, tokens.quoted(), size_t(parameter_counter), position, taken);
+					PARAMS_STAT_CONVERT(parameter, taken);
+					if (outcome.failure != Failure::NONE)
+						return outcome;
+					slot->xargsRead += int(taken);
+					parameter_counter -= int(taken);
+				}
+				if (slot->xargsRead >= parameter->xargs) {
+					slot->set = true;
+				}
+			}
+#undef PARAMS_STAT_TOKEN
+#undef PARAMS_STAT_CONVERT
+			PARAMS_STAT(stats.tokenizeSeconds += watch.lap();)
+			if (tokens.failed()) {
+				outcome.failure = Failure::UNREADABLE_FILE;
+				outcome.text = tokens.failure();
+			}
+			return outcome;
+		}
+
+#if PARAMS_DEFINE
+		PARAMS_API Outcome finishParse(Slot* slots, size_t count, [[maybe_unused]] Stats& stats) {
+			Outcome outcome;
+			PARAMS_STAT(Stopwatch watch;)
+			for (size_t i=0; i<count; ++i) { // in the order of the params, which is that of their ids
+				Slot& slot = slots[i];
+				const Param* param = slot.param;
+				if (param->required && !slot.set) {
+					outcome.failure = Failure::MISSING_REQUIRED;
+					outcome.param = param;
+					break;
+				}
+				if (param->list && param->xargs > slot.xargsRead && param->defaultValue != "") {
+					// the missing values are one default, converted once
+					PARAMS_STAT(size_t capacity = param->ops->capacity(slot.destination); ++stats.converted[int(param->type)];)
+					errc result = param->ops->fill(slot.destination, size_t(slot.xargsRead), size_t(param->xargs-slot.xargsRead), param->defaultValue, param->constraint);
+					PARAMS_STAT(stats.allocations += (param->ops->capacity(slot.destination) != capacity);)
+					if (result != errc()) {
+						outcome = valueFailure(result, param, 0, param->defaultValue);
+						break;
+					}
+				}
+			}
+			PARAMS_STAT(stats.validateSeconds += watch.lap();)
+			return outcome;
+		}
+
+#endif
+
+		template<typename Names> Outcome parseAll(const Names& names, Tokenizer& tokens, Slot* slots, size_t count, Stats& stats) {
+			stats = Stats();
+			Outcome outcome = parseTokens(names, tokens, slots, stats);
+			if (outcome.failure == Failure::NONE && !outcome.help) {
+				outcome = finishParse(slots, count, stats);
+			}
+			PARAMS_STAT(tokens.collect(stats);)
+			return outcome;
+		}
+
+#if PARAMS_DEFINE
+		PARAMS_API char** environment() {
+#if PARAMS_HAVE_MMAP
+			return environ;
+#elif defined(_WIN32)
+			return _environ;
+#else
+			return nullptr;
+#endif
+		}
+
+		// The option named by an environment variable "NAME=value" with the prefix: the rest of
+		// NAME lowercased with '_' as '-' after "--", so SIM_NUM_THREADS is --num-threads.
+		PARAMS_API bool environmentKey(const char* variable, string_view prefix, string& key) {
+			if (strncmp(variable, prefix.data(), prefix.size()) != 0)
+				return false;
+			const char* name = variable+prefix.size();
+			const char* equals = strchr(name, '=');
+			if (equals == nullptr || equals == name)
+				return false;
+			key.assign("--");
+			for (const char* c = name; c != equals; ++c) {
+				key += (*c == '_') ? '-' : char(tolower((unsigned char)*c));
+			}
+			return true;
+		}
+
+		PARAMS_API Outcome parseSources(const Registry& registry, const Sources& sources, vector<Slot>& slots, Stats& stats, string& failedText, const function<bool(string_view)>& command) {
+			stats = Stats();
+			Outcome outcome;
+			auto failed = [&]() {
+				failedText.assign(outcome.text.data(), outcome.text.size()); // the input goes away with the Tokenizer
+				outcome.text = failedText;
+				return true;
+			};
+			auto run = [&](Tokenizer& tokens, unsigned source) {
+				outcome = parseTokens(registry, tokens, slots.data(), stats, source);
+				PARAMS_STAT(tokens.collect(stats);)
+				return (outcome.failure != Failure::NONE && failed()) || outcome.help;
+			};
+			if (sources.config != nullptr) {
+				MappedFile file;
+				if (!file.open(sources.config)) {
+					outcome.failure = Failure::UNREADABLE_FILE;
+					outcome.text = sources.config;
+					failed();
+					return outcome;
+				}
+				Tokenizer tokens(string_view(file.begin(), size_t(file.end()-file.begin())));
+				if (run(tokens, 1))
+					return outcome;
+			}
+			char** variables = environment();
+			if (sources.environment != nullptr && sources.environment[0] != '\0' && variables != nullptr) {
+				string key;
+				for (char** variable = variables; *variable != nullptr; ++variable) {
+					if (!environmentKey(*variable, sources.environment, key))
+						continue;
+					const char* value = strchr(*variable, '=')+1;
+					const Param* param = registry.find(key);
+					if (param == nullptr)
+						continue; // not ours, see Sources::environment
+					if (param->type == TYPE::BOOL && (*value == '\0' || strcmp(value, "0") == 0 || equalsNoCase(value, "false")))
+						continue; // a flag is set by any other value
+					// the value is tokenized in place like one argv entry after the option
+					char* entries[] = {const_cast<char*>(""), &key[0], (param->type == TYPE::BOOL) ? nullptr : const_cast<char*>(value), nullptr};
+					Tokenizer tokens(entries);
+					if (run(tokens, 2))
+						return outcome;
+				}
+			}
+			if (sources.argv != nullptr) {
+				Tokenizer tokens(sources.argv);
+				outcome = parseTokens(registry, tokens, slots.data(), stats, 3);
+				if (outcome.failure == Failure::UNKNOWN_OPTION && command && command(outcome.text)) { // its options have slots now
+					outcome = parseTokens(registry, tokens, slots.data(), stats, 3, outcome.token+1);
+				}
+				PARAMS_STAT(tokens.collect(stats);)
+				if ((outcome.failure != Failure::NONE && failed()) || outcome.help)
+					return outcome;
+			}
+			outcome = finishParse(slots.data(), slots.size(), stats);
+			return outcome;
+		}
+
+		// the message of a value outside the constraint of option name, token 0 if not known
+		PARAMS_API string notAllowed(string_view name, const Constraint& constraint, size_t token, string_view text) {
+			string message = "Value '";
+			message += text;
+			message += "' of option '";
+			message += name;
+			message += "' is not allowed";
+			if (token != 0) {
+				message += " (token ";
+				message += to_string(token);
+				message += ")";
+			}
+			message += ": ";
+			message += constraint.rule;
+			return message;
+		}
+
+		PARAMS_API string describe(const Outcome& outcome) {
+			string message;
+			string_view name = (outcome.param != nullptr) ? outcome.param->longPhrase : string_view();
+			switch(outcome.failure) {
+				case Failure::NONE:
+					break;
+				case Failure::UNKNOWN_OPTION:
+					message += "Unrecognized option '";
+					message += outcome.text;
+					message += "' in invocation.";
+					break;
+				case Failure::BAD_VALUE:
+				case Failure::OUT_OF_RANGE:
+					if (outcome.param->type == TYPE::BOOL) {
+						message += "Unrecognized default value for boolean option: '";
+						message += outcome.text;
+						message += "'";
+						break;
+					}
+					message += (outcome.failure == Failure::OUT_OF_RANGE) ? "Error in argument (out of range for type " : "Error in argument (expected type ";
+					message += typeName(outcome.param->type);
+					message += "): ";
+					message += outcome.text;
+					if (outcome.param->list) {
+						message += "\nOptions which expect infinite arguments should be last.";
+					}
+					break;
+				case Failure::MISSING_REQUIRED:
+					message += "Option '";
+					message += name;
+					message += "' required, and not found, or incomplete.";
+					break;
+				case Failure::UNREADABLE_FILE:
+					message += "Could not read response file '";
+					message += outcome.text;
+					message += "'.";
+					break;
+				case Failure::AMBIGUOUS_OPTION:
+					message += "Option '";
+					message += outcome.text;
+					message += "' is ambiguous, it starts the names of several options.";
+					break;
+				case Failure::NOT_ALLOWED:
+					message += notAllowed(name, *outcome.param->constraint, outcome.token, outcome.text);
+					break;
+				case Failure::TOO_MANY_VALUES:
+					message += "Option '";
+					message += name;
+					message += "' takes ";
+					message += to_string(outcome.param->xargs);
+					message += " arguments, more were given: ";
+					message += outcome.text;
+					break;
+			}
+			return message;
+		}
+
+		// the strings of the copy in one buffer of its own, which is never reallocated
+		struct KeptConstraint : Constraint {
+			string strings;
+		};
+
+		PARAMS_API void keepConstraint(shared_ptr<const Constraint>& kept, const Constraint* constraint) {
+			if (constraint == nullptr) {
+				kept.reset();
+				return;
+			}
+			if (kept != nullptr && kept->serial == constraint->serial)
+				return;
+			shared_ptr<KeptConstraint> copy = make_shared<KeptConstraint>();
+			static_cast<Constraint&>(*copy) = *constraint;
+			size_t size = copy->described.size() + copy->rule.size() + copy->help.size();
+			for (string_view choice : copy->choices) {
+				size += choice.size();
+			}
+			copy->strings.reserve(size);
+			auto own = [&](string_view& text) {
+				size_t begin = copy->strings.size();
+				copy->strings += text;
+				text = string_view(copy->strings.data()+begin, text.size());
+			};
+			for (string_view& choice : copy->choices) {
+				own(choice);
+			}
+			own(copy->described);
+			own(copy->rule);
+			own(copy->help);
+			kept = move(copy);
+		}
+
+		PARAMS_API string lazyFailure(TYPE type, string_view name, const Constraint* constraint, errc result, string_view text) {
+			if (result == errc::argument_out_of_domain)
+				return notAllowed(name, *constraint, 0, text);
+			string message = "Error in argument";
+			if (!name.empty()) {
+				message += " of '";
+				message += name;
+				message += "'";
+			}
+			message += (result == errc::result_out_of_range) ? " (out of range for type " : " (expected type ";
+			message += typeName(type);
+			message += "): ";
+			message += text;
+			return message;
+		}
+
+		// slots writing straight into the bound variables, reusing the vector's storage, from id first on
+		// (those before keep their state); kept is the length of a list before the parse, as the cache saves it
+		PARAMS_API void bindSlots(const Registry& registry, vector<Slot>& slots, size_t first) {
+			slots.resize(registry.params.size());
+			for (size_t id=first; id<slots.size(); ++id) {
+				const Param* param = registry.params[id];
+				slots[id] = Slot{param, param->destination, 0, param->type == TYPE::BOOL};
+				slots[id].kept = param->list ? param->ops->length(param->destination) : 0;
+			}
+		}
+
+#endif
+
+		inline constexpr string_view typeNames[] = {"bool.", "int.", "unsigned int.", "float.", "long.", "double.", "char.", "string."}; // in TYPE order
+
+		// Renders the argdetails() text of one param, handing every non-empty piece to output(string_view)
+		// without building intermediate strings. Also run at compile time for StaticParser.
+		template<typename Output> constexpr void renderParam(const Param& param, Output&& output) {
+			auto write = [&](string_view piece) {
+				if (!piece.empty()) {
+					output(piece);
+				}
+			};
+			write("\t");
+			write(param.longPhrase);
+			for (const Alias* alias = param.aliases; alias != nullptr; alias = alias->next) {
+				write(", ");
+				write(alias->name);
+			}
+			write("\n\t\t");
+			write(param.helpPhrase);
+			if (param.xargs > 0 && param.type != TYPE::BOOL) {
+				char digits[16] = {};
+				size_t length = 0;
+				for (int value = param.xargs; value > 0; value /= 10) {
+					digits[15-length++] = char('0' + value%10);
+				}
+				write("\n\t\t");
+				write(string_view(digits+16-length, length));
+				write((param.xargs != 1) ? " arguments of type " : " argument of type ");
+				write(typeNames[static_cast<int>(param.type)]);
+			}
+			if (param.delimiter != 0) {
+				write("\n\t\tvalues may be joined by '");
+				write(string_view(&param.delimiter, 1));
+				write("'");
+			}
+			if (param.constraint != nullptr) {
+				write(param.constraint->help);
+			}
+			if (param.required == false) {
+				write("\n\t\tdefault: '");
+				write(param.defaultValue);
+				write("'");
+			}
+			write("\n");
+		}
+
+		// the argdetails() text in one pass over the params sorted by name
+		template<typename Output> void renderDetails(const Registry& registry, Output&& output) {
+			for (const Param* param : registry.byName()) {
+				renderParam(*param, output);
+			}
+		}
+	}
+
+	class Schema;
+
+	// What tryparse returns: Failure::NONE, or the failure with the option it concerns (empty if none, such as
+	// for an unknown option) and the position of the offending token in the input, counting values.
+	struct Error {
+		Failure code = Failure::NONE;
+		string_view option; // the registered name, valid until the options change
+		size_t token = 0;
+		explicit operator bool() const { return code != Failure::NONE; } // true on failure
+	};
+
+	// Returned by addp to refine the option just registered, for example
+	//   addp(&weights, -1, "--weights", "The weights.").delimiter(',');
+	class Option {
+		private:
+			priv::Registry* registry;
+			priv::Param* param;
+			priv::Constraint& constraint(); // of the option, made on first use
+			Option& constrained(); // describes the constraint again and checks the default against it
+			Option& check(function<bool(const void*)> predicate, string_view description);
+		public:
+			Option(priv::Registry* _registry, priv::Param* _param) : registry(_registry), param(_param) {}
+			// also take the values of a list as one token split at separator, such as --weights=1,2,3
+			Option& delimiter(char separator);
+			// another name for the option, such as a short flag: addp(&seed, "--seed", "The seed.").alias("-s");
+			// a name which another option already has is an error
+			Option& alias(string_view name);
+			// converts the plain values of a long numeric list on this many threads (0 for one per core), with the
+			// same values and errors as on one; pays off from about a megabyte of values per thread
+			Option& parallel(unsigned threads=0);
+			// Constraints on the values, checked as each one is converted; a value outside them is an error naming
+			// the option and the token, and argdetails() shows them. Numeric values from low to high, which
+			// INT, UINT and LONG options compare as integers, so range(1, LONG_MAX-1) is exact:
+			//   addp(&rate, "--rate", "The learning rate.").range(0, 1);
+			Option& range(priv::Bound low, priv::Bound high);
+			// STRING or CHAR values which must be one of these: addp(&mode, "--mode", "...").choices({"fast", "exact"});
+			Option& choices(initializer_list<string_view> allowed);
+			// values for which predicate is true, given each converted value (a string_view for STRING), on other
+			// threads too with parallel(); argdetails() shows "must be " and the description:
+			//   addp(&sizes, -1, "--sizes", "...").check([](int size) { return size%2 == 0; }, "even");
+			template<typename F> Option& check(F predicate, string_view description);
+	};
+
+	// A member of a config struct bound to an option, see Parser::addFields. The TYPE follows from the member
+	// type, and so does the count unless given: any number of values for a vector or a Sink, the size of an
+	// array, Buffer or span, else 1. Members of other types, such as pair or tuple, are not supported.
+	template<typename S, typename M> struct Field {
+		M S::* member;
+		int xargs;
+		bool required;
+		const char* defaultValue;
+		const char* longPhrase;
+		const char* helpPhrase;
+		const char* aliasName = nullptr;
+		constexpr Field alias(const char* name) const { Field named = *this; named.aliasName = name; return named; }
+	};
+
+	namespace priv {
+		template<typename M> constexpr int fieldCount() { return (Binding<M>::list && !Binding<M>::fixed) ? -1 : 1; }
+	}
+
+	// field(&Config::member, ...) overloads, with the arguments of addp after the destination
+	template<typename S, typename M> constexpr Field<S,M> field(M S::* _member, const char* _longPhrase, const char* _helpPhrase) {
+		return Field<S,M>{_member, priv::fieldCount<M>(), true, "", _longPhrase, _helpPhrase};
+	}
+
+	template<typename S, typename M> constexpr Field<S,M> field(M S::* _member, const char* _defaultValue, const char* _longPhrase, const char* _helpPhrase) {
+		return Field<S,M>{_member, priv::fieldCount<M>(), false, _defaultValue, _longPhrase, _helpPhrase};
+	}
+
+	template<typename S, typename M> constexpr Field<S,M> field(M S::* _member, bool _required, const char* _longPhrase, const char* _helpPhrase) {
+		return Field<S,M>{_member, priv::fieldCount<M>(), _required, "", _longPhrase, _helpPhrase};
+	}
+
+	template<typename S, typename M> constexpr Field<S,M> field(M S::* _member, int _xargs, const char* _longPhrase, const char* _helpPhrase) {
+		return Field<S,M>{_member, _xargs, true, "", _longPhrase, _helpPhrase};
+	}
+
+	template<typename S, typename M> constexpr Field<S,M> field(M S::* _member, int _xargs, const char* _defaultValue, const char* _longPhrase, const char* _helpPhrase) {
+		return Field<S,M>{_member, _xargs, false, _defaultValue, _longPhrase, _helpPhrase};
+	}
+
+	class View;
+
+	// A Parser owns its registry and all parse state, so separate Parsers can be
+	// used from different threads without locking. The free functions below use a default one.
+	class Parser {
+		private:
+			friend class Schema;
+			priv::Registry registry;
+			Stats lastStats;
+			string details; // argdetails() text, rendered for detailsGeneration of the registry
+			size_t detailsGeneration = size_t(-1);
+			string lastError;
+			vector<priv::Slot> slots; // of argparse, kept so that later parses do not allocate
+			struct Command {
+				string name;
+				string helpPhrase;
+				function<void(Parser&)> setup;
+			};
+			vector<Command> commands;
+			size_t active = SIZE_MAX; // the command the last parse picked, whose options are registered
+			size_t setUp = SIZE_MAX; // the command whose setup registered commandParams
+			vector<priv::Param*> commandParams; // kept while unregistered, so the same command is picked again cheaply
+			void park(); // unregisters the options of the active command, a parse starts with those registered directly
+			bool pick(string_view name); // registers the options of the command by that name, false if there is none
+			template<typename Output> void render(Output&& output) const; // the options, then the commands
+		public:
+			Option addp(TYPE _type, void* _destination) { // for the help flag
+				return Option(&registry, registry.addUntyped(_type, _destination, 1, false, "", "--help", "Prints this help message."));
+			}
+
+			Option addp(TYPE _type, void* _destination, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, 1, true, "", _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, _xargs, true, "", _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, string _defaultValue, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, 1, false, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, string _defaultValue, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, _xargs, false, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, 1, _required, "", _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, _xargs, _required, "", _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, 1, _required, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addUntyped(_type, _destination, _xargs, _required, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			// A default given as a literal, which would otherwise convert to bool and make the option required.
+			Option addp(TYPE _type, void* _destination, const char* _defaultValue, string _longPhrase, string _helpPhrase) {
+				return addp(_type, _destination, string(_defaultValue), _longPhrase, _helpPhrase);
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, const char* _defaultValue, string _longPhrase, string _helpPhrase) {
+				return addp(_type, _destination, _xargs, string(_defaultValue), _longPhrase, _helpPhrase);
+			}
+
+			Option addp(TYPE _type, void* _destination, const char* _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return addp(_type, _destination, string(_defaultValue), _required, _longPhrase, _helpPhrase);
+			}
+
+			Option addp(TYPE _type, void* _destination, int _xargs, const char* _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return addp(_type, _destination, _xargs, string(_defaultValue), _required, _longPhrase, _helpPhrase);
+			}
+
+			// Typed registration: TYPE and the setter follow from the destination type,
+			// same signatures as above without the TYPE argument. Options with xargs != 1 bind to a vector.
+			Option addp(bool* _destination) { // for the help flag
+				return Option(&registry, registry.addTyped(_destination, 1, false, "", "--help", "Prints this help message."));
+			}
+
+			template<typename T> Option addp(T* _destination, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, 1, true, "", _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, _xargs, true, "", _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, string _defaultValue, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, 1, false, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, string _defaultValue, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, _xargs, false, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, 1, _required, "", _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, _xargs, _required, "", _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, 1, _required, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, string _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return Option(&registry, registry.addTyped(_destination, _xargs, _required, _defaultValue, _longPhrase, _helpPhrase));
+			}
+
+			template<typename T> Option addp(T* _destination, const char* _defaultValue, string _longPhrase, string _helpPhrase) {
+				return addp(_destination, string(_defaultValue), _longPhrase, _helpPhrase);
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, const char* _defaultValue, string _longPhrase, string _helpPhrase) {
+				return addp(_destination, _xargs, string(_defaultValue), _longPhrase, _helpPhrase);
+			}
+
+			template<typename T> Option addp(T* _destination, const char* _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return addp(_destination, string(_defaultValue), _required, _longPhrase, _helpPhrase);
+			}
+
+			template<typename T> Option addp(T* _destination, int _xargs, const char* _defaultValue, bool _required, string _longPhrase, string _helpPhrase) {
+				return addp(_destination, _xargs, string(_defaultValue), _required, _longPhrase, _helpPhrase);
+			}
+
+			// Binds members of a config struct to options in one go, so that related values lie together in memory
+			// and the struct can be copied, compared or hashed as a unit. The struct must outlive the Parser's use.
+			//   struct Config { int iterations; double rate; vector<float> weights; } config;
+			//   parser.addFields(config, field(&Config::iterations, "--iterations", "Iterations."),
+			//           field(&Config::rate, "0.5", "--rate", "Rate."), field(&Config::weights, "--weights", "Weights."));
+			template<typename S, typename... M> void addFields(S& target, const Field<S,M>&... fields);
+
+			void argparse(char** argv);
+			// reads a config file, the environment and argv in one pass, see Sources; the required
+			// options and the defaults of lists are checked once, over what all of them gave
+			void argparse(const Sources& sources);
+			// Like argparse, through a cache file of the parsed values: when cachePath holds those of the same
+			// options and the same argv (with unchanged response files), they are copied into the variables
+			// from one mapping instead, and true is returned. Otherwise argv is parsed and the cache rewritten.
+			// A null cachePath parses without a cache, as do options with a Sink, a Lazy or a check() predicate
+			// and argv reading stdin.
+			bool argparse(char** argv, const char* cachePath);
+			// Like argparse, but returns instead of exiting: on failure the bound variables are left unchanged
+			// and errordetails() has the message argparse would print. Values are parsed into staged copies
+			// and moved over (lists appended) once the whole invocation is valid.
+			Error tryparse(char** argv);
+			Error tryparse(const Sources& sources);
+			const string& errordetails() const { return lastError; } // of the last failed tryparse
+			// The help text is rendered once and kept until the options change, the reference until then too.
+			const string& argdetails();
+			void argdetails(FILE* out) const; // streams the same text without building it
+			void argdetails(ostream& out) const;
+			size_t argdetails(char* buffer, size_t size) const; // like snprintf: the full length, written up to size-1 and terminated
+			void reset(); // forgets all registered options and releases their storage at once
+			// accept an unambiguous start of an option name such as --iter for --iterations (off by default)
+			void allowPrefixes(bool allowed=true) { registry.prefixes = allowed; registry.index.invalidate(); }
+			Schema compile() const;
+			// A subcommand: when name is the first argument which is not an option or its value, such as train
+			// in tool --verbose train --epochs 3, setup registers the options of the command on this parser, and
+			// the rest of argv is parsed against those and the ones registered directly. The options of the other
+			// commands are never registered, so neither looked up, nor checked for being required, nor listed.
+			//   parser.command("train", "Trains a model.", [&](Parser& p) { p.addp(&epochs, "--epochs", "Epochs."); });
+			void command(string name, string helpPhrase, function<void(Parser&)> setup);
+			string_view activeCommand() const { return (active != SIZE_MAX) ? string_view(commands[active].name) : string_view(); }
+			// the options and their current values in shared memory for other processes, see View;
+			// options with a Sink or a Lazy hold no converted values and are left out, and the View is empty where memory cannot be shared
+			View publish() const;
+			const Stats& stats() const { return lastStats; } // of the last argparse, see PARAMS_STATS
+	};
+
+	// The values of one parse against a Schema. They are owned by the Result, bound variables are not touched.
+	// A Result refers to its Schema, which must outlive it.
+	class Result {
+		private:
+			friend class Schema;
+			const priv::Registry* registry = nullptr;
+			vector<priv::Slot> slots;
+			string message;
+			bool help = false;
+			Stats parseStats;
+			void release();
+		public:
+			Result() = default;
+			Result(const Result&) = delete;
+			Result(Result&& other) noexcept;
+			Result& operator=(Result&& other) noexcept;
+			~Result();
+			bool ok() const { return message.empty(); }
+			const string& error() const { return message; } // same text argparse would print, empty if ok
+			bool helpRequested() const { return help; }
+			const Stats& stats() const { return parseStats; } // see PARAMS_STATS
+			template<typename T> const T* get(string_view longPhrase) const; // nullptr if unknown or not a T
+	};
+
+	// An immutable copy of a Parser's options, compiled once. Parsing against it never writes through
+	// the bound destination pointers, and one Schema may be used from several threads at once.
+	class Schema {
+		private:
+			priv::Registry registry;
+			Result parseFrom(priv::Tokenizer& tokens) const;
+		public:
+			explicit Schema(const Parser& parser);
+			~Schema();
+			Schema(const Schema&) = delete;
+			Schema& operator=(const Schema&) = delete;
+			Result parse(char** argv) const;
+			// parses every argv of the batch, spread over threads (0 for one per core)
+			vector<Result> parse(const vector<char**>& batch, unsigned threads=1) const;
+			// parses the text of a config file, such as one --key=value per line, see Reloader
+			Result parseConfig(string_view text) const;
+	};
+
+	namespace priv {
+		struct Watch;
+
+		// A Result published by a Reloader. These holders are reused but only freed with the Reloader,
+		// so a reader may pin one which is no longer current, notice, and let go again.
+		struct Published {
+			Result result;
+			size_t version = 0;
+			atomic<size_t> pins{0}; // Snapshots holding it
+		};
+
+		// what tells a changed file apart without reading it: size, modification time and inode
+		struct FileStamp {
+			long long values[5] = {};
+			bool operator==(const FileStamp& other) const { return memcmp(values, other.values, sizeof(values)) == 0; }
+			bool operator!=(const FileStamp& other) const { return !(*this == other); }
+		};
+		PARAMS_API bool stampFile(const char* path, FileStamp& stamp); // false where stat is not available
+		PARAMS_API bool readFile(const char* path, string& contents);
+
+		// A cache file holds the values one parse wrote, to be copied into the variables of a later run.
+		// It is the header, then for each param in registry order a byte telling whether the parse wrote it,
+		// and if so the 64 bit length of its value and the value as Ops::save encodes it. No pointers.
+		struct CacheHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t byteOrder; // 0x01020304 as the writer stored it
+			uint64_t key; // of the options registered directly and the input, see cacheKey
+			uint64_t command; // 1 + the index of the command the parse picked, 0 for none
+			uint64_t options; // optionsKey once the options of that command are registered too
+			uint64_t count; // records
+			uint64_t length; // bytes of records after the header
+			uint64_t checksum; // of those bytes
+		};
+		PARAMS_API uint64_t hashBytes(const void* data, size_t size, uint64_t h);
+		PARAMS_API uint64_t optionsKey(const Registry& registry);
+		PARAMS_API uint64_t cacheKey(const Registry& registry, char** argv);
+		// false with a Sink or Lazy destination or stdin as a response file, whose values cannot be replayed,
+		// and with a check() predicate, which the key could only tell apart from another by its description
+		PARAMS_API bool cacheable(const Registry& registry, char** argv);
+		// the command of the cache at path, if it was written for key
+		PARAMS_API bool cachedCommand(uint64_t key, const char* path, uint64_t& command);
+		PARAMS_API bool loadCache(const Registry& registry, uint64_t key, uint64_t options, const char* path);
+		PARAMS_API bool saveCache(const Registry& registry, const vector<Slot>& slots, uint64_t key, uint64_t command, const char* path);
+		// of the free functions, one for the whole program also when every translation unit inlines it
+		PARAMS_API Parser& defaultParser();
+
+		// A published block, see View: the header, the entries sorted by name (a long name or an alias, so an option
+		// may have several), the names, then the values of each option at a multiple of 8 bytes. Offsets count from
+		// the start of the block, so it can be mapped anywhere. Numbers, bool and char are their bytes, as in the
+		// cache; strings are count+1 offsets (of each start and of the end), then their bytes.
+		struct ViewHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t byteOrder; // 0x01020304 as the writer stored it
+			uint64_t shape; // hash of the type sizes
+			uint64_t count; // entries
+			uint64_t length; // of the whole block
+		};
+		struct ViewEntry {
+			uint64_t name;
+			uint64_t nameLength;
+			uint64_t values;
+			uint64_t count; // values
+			uint32_t type; // TYPE
+			uint32_t list;
+		};
+		PARAMS_API string publishBlock(const Registry& registry);
+		PARAMS_API bool checkBlock(const char* block, size_t length);
+	}
+
+	// Values of a list in a View: the numbers in the block, or strings as views into it.
+	template<typename T> class ViewList {
+		private:
+			friend class View;
+			const char* block = nullptr;
+			const char* values = nullptr; // the numbers, or the offsets of the strings
+			size_t count = 0;
+		public:
+			class iterator {
+				private:
+					const ViewList* list;
+					size_t index;
+				public:
+					iterator(const ViewList* _list, size_t _index) : list(_list), index(_index) {}
+					T operator*() const { return (*list)[index]; }
+					iterator& operator++() { ++index; return *this; }
+					bool operator==(const iterator& other) const { return index == other.index; }
+					bool operator!=(const iterator& other) const { return index != other.index; }
+			};
+			size_t size() const { return count; }
+			bool empty() const { return count == 0; }
+			T operator[](size_t index) const {
+				if constexpr (is_same<T,string_view>::value) {
+					const uint64_t* offsets = reinterpret_cast<const uint64_t*>(values);
+					return string_view(block+offsets[index], size_t(offsets[index+1]-offsets[index]));
+				} else {
+					return reinterpret_cast<const T*>(values)[index];
+				}
+			}
+			iterator begin() const { return iterator(this, 0); }
+			iterator end() const { return iterator(this, count); }
+	};
+
+	// Read only access to the options and values of a parse, laid out by publish() in one block of shared memory
+	// without pointers. Worker processes forked after publish() read through the View they inherit, others map
+	// the block from fd(), which stays open across exec. Reading copies nothing and allocates nothing.
+	//   View shared = publish(); if (fork() == 0) { const int* threads = shared.get<int>("--threads"); }
+	class View {
+		private:
+			friend class Parser;
+			const char* block = nullptr;
+			size_t length = 0;
+			int descriptor = -1;
+			const priv::ViewEntry* find(string_view name, TYPE type, bool list) const;
+		public:
+			View() = default;
+			explicit View(int fd); // maps the block of fd (which stays the caller's) read only, empty if it is not one
+			View(const View&) = delete;
+			View& operator=(const View&) = delete;
+			View(View&& other) noexcept;
+			View& operator=(View&& other) noexcept;
+			~View();
+			explicit operator bool() const { return block != nullptr; }
+			int fd() const { return descriptor; }
+			// a single number, bool or char by a name of its option; nullptr if unknown or not a T
+			template<typename T> const T* get(string_view name) const;
+			string_view text(string_view name) const; // a single string, empty if unknown or not a string
+			// the values of a list, T string_view for strings; empty if unknown or not a list of T
+			template<typename T> ViewList<T> list(string_view name) const;
+	};
+
+	// Read access to the values a Reloader published, which stay unchanged as long as it is held.
+	class Snapshot {
+		private:
+			friend class Reloader;
+			priv::Published* published = nullptr;
+			explicit Snapshot(priv::Published* _published) : published(_published) {}
+		public:
+			Snapshot() = default;
+			Snapshot(const Snapshot& other) : published(other.published) { if (published != nullptr) published->pins.fetch_add(1); }
+			Snapshot(Snapshot&& other) noexcept : published(other.published) { other.published = nullptr; }
+			Snapshot& operator=(Snapshot other) noexcept { swap(published, other.published); return *this; }
+			~Snapshot() { if (published != nullptr) published->pins.fetch_sub(1); }
+			explicit operator bool() const { return published != nullptr; } // false until a first good load
+			const Result& operator*() const { return published->result; }
+			const Result* operator->() const { return &published->result; }
+			size_t version() const { return (published != nullptr) ? published->version : 0; } // counts the loads
+	};
+
+	// Keeps the values of a config file current for a long running program. The file is parsed against
+	// a Schema (which must outlive the Reloader, as must the Snapshots) and published as a new immutable
+	// Result with one atomic pointer swap; snapshot() never locks and never sees half an update.
+	// A file which fails to read or parse leaves the previous values published, see error().
+	//   Schema schema = compile(); Reloader tunables(schema, "server.conf"); tunables.watch(chrono::seconds(1));
+	//   Snapshot now = tunables.snapshot(); if (now) { const double* rate = now->get<double>("--rate"); }
+	class Reloader {
+		private:
+			const Schema& schema;
+			string path;
+			atomic<priv::Published*> current{nullptr};
+			vector<unique_ptr<priv::Published>> published; // reused once nothing pins them
+			size_t version = 0;
+			priv::FileStamp stamp; // of the file last published
+			unique_ptr<priv::Watch> watching; // the locks and the background thread
+			string lastError;
+			bool update(bool force);
+			void publish(Result&& result);
+		public:
+			Reloader(const Schema& _schema, string _path); // loads the file once
+			~Reloader();
+			Reloader(const Reloader&) = delete;
+			Reloader& operator=(const Reloader&) = delete;
+			bool reload() { return update(true); } // reads the file now, true if new values were published
+			// checks the file every interval on a background thread and reloads it when it changed
+			void watch(chrono::milliseconds interval);
+			void stop();
+			Snapshot snapshot() const;
+			string error() const; // why the last load failed, empty once one succeeds
+	};
+
+	// One option of a StaticParser, made by option() in a constant expression.
+	typedef priv::Param StaticOption;
+
+	namespace priv {
+		template<typename T> struct FixedCount { static constexpr size_t value = 0; };
+		template<typename T, size_t N> struct FixedCount<array<T,N>> { static constexpr size_t value = N; };
+
+		// Registration errors of option(): a compile error where the table is constexpr, exits otherwise.
+		PARAMS_API void optionError(const char* message, string_view longPhrase);
+
+		template<typename T> constexpr StaticOption makeOption(T* _destination, int _xargs, bool _required, string_view _defaultValue, string_view _longPhrase, string_view _helpPhrase) {
+			static_assert(!is_same<T, vector<bool>>::value, "BOOL options are flags and bind to a bool.");
+			static_assert(!Binding<T>::fixed || FixedCount<T>::value != 0, "A StaticParser binds fixed counts to array<T,N>, whose size is known at compile time.");
+			if (!Binding<T>::list && Binding<T>::type != TYPE::BOOL && _xargs != 1) {
+				optionError("Option '%.*s' takes several arguments and must be bound to a vector.\n", _longPhrase);
+			}
+			if (Binding<T>::fixed && _xargs == 1) {
+				_xargs = int(FixedCount<T>::value);
+			}
+			if (Binding<T>::fixed && (_xargs < 0 || size_t(_xargs) > FixedCount<T>::value)) {
+				optionError("Option '%.*s' takes more arguments than its destination holds.\n", _longPhrase);
+			}
+			return StaticOption(Binding<T>::type, &Binding<T>::ops, Binding<T>::list, _destination, _longPhrase, _helpPhrase, _xargs, _required, _defaultValue);
+		}
+
+		// The option table of a StaticParser, sorted by name with ids set, and its hash table of
+		// param index + 1 (0 for empty slots), all built at compile time.
+		template<size_t N> struct StaticTable {
+			static constexpr size_t capacity() {
+				size_t size = 8;
+				while (size < 2*N) {
+					size *= 2;
+				}
+				return size;
+			}
+			template<typename Options> static constexpr array<size_t,N> order(const Options& options) {
+				array<size_t,N> order{};
+				for (size_t i=0; i<N; ++i) {
+					size_t j = i;
+					for (; j > 0 && options[i].longPhrase < options[order[j-1]].longPhrase; --j) {
+						order[j] = order[j-1];
+					}
+					order[j] = i;
+				}
+				return order;
+			}
+			static constexpr StaticOption numbered(StaticOption param, size_t id) {
+				param.id = id;
+				return param;
+			}
+			template<typename Options, size_t... I> static constexpr array<StaticOption,N> sorted(const Options& options, index_sequence<I...>) {
+				array<size_t,N> positions = order(options);
+				return array<StaticOption,N>{{numbered(options[positions[I]], I)...}};
+			}
+			template<typename Options> static constexpr array<StaticOption,N> sorted(const Options& options) {
+				return sorted(options, make_index_sequence<N>());
+			}
+			static constexpr array<uint32_t,capacity()> hashed(const array<StaticOption,N>& params) {
+				array<uint32_t,capacity()> table{};
+				for (size_t i=0; i<N; ++i) {
+					size_t slot = hashName(params[i].longPhrase) & (capacity()-1);
+					while (table[slot] != 0) {
+						slot = (slot+1) & (capacity()-1);
+					}
+					table[slot] = uint32_t(i+1);
+				}
+				return table;
+			}
+			static constexpr bool unique(const array<StaticOption,N>& params) {
+				for (size_t i=1; i<N; ++i) {
+					if (params[i-1].longPhrase == params[i].longPhrase)
+						return false;
+				}
+				return true;
+			}
+			static constexpr size_t detailsLength(const array<StaticOption,N>& params) {
+				size_t length = 0;
+				for (const StaticOption& param : params) {
+					renderParam(param, [&](string_view piece) { length += piece.size(); });
+				}
+				return length;
+			}
+			template<size_t Length> static constexpr array<char,Length+1> details(const array<StaticOption,N>& params) {
+				array<char,Length+1> text{};
+				size_t length = 0;
+				for (const StaticOption& param : params) {
+					renderParam(param, [&](string_view piece) {
+						for (char c : piece) {
+							text[length++] = c;
+						}
+					});
+				}
+				return text;
+			}
+		};
+
+		// The Names of parseTokens over a StaticTable: exact names only.
+		struct StaticNames {
+			const StaticOption* params;
+			const uint32_t* table;
+			size_t mask;
+			bool prefixes = false;
+			const Param* find(string_view name) const {
+				for (size_t slot = hashName(name) & mask; table[slot] != 0; slot = (slot+1) & mask) {
+					if (params[table[slot]-1].longPhrase == name) {
+						return &params[table[slot]-1];
+					}
+				}
+				return nullptr;
+			}
+			const Param* findPrefix(string_view, bool& ambiguous) const {
+				ambiguous = false;
+				return nullptr;
+			}
+		};
+	}
+
+	// Options declared at compile time: the sorted table, the lookup index and the help text are
+	// constants, so a StaticParser needs no registration, no dynamic initialization and parses
+	// without allocating (only the values themselves may, such as long strings and vectors).
+	//   static int iterations; static bool help;
+	//   static constexpr StaticOption options[] = {
+	//   	option(&iterations, "--iterations", "The number of iterations to perform."),
+	//   	option(&help),
+	//   };
+	//   static StaticParser<options> parser; // parser.argparse(argv);
+	// Options must be a constexpr array with static storage duration, and the variables too.
+	// Two options of the same name fail to compile, as do bad counts.
+	template<const auto& Options> class StaticParser {
+		private:
+			static constexpr size_t count = size(Options);
+			typedef priv::StaticTable<count> Table;
+			static constexpr array<StaticOption,count> params = Table::sorted(Options);
+			static_assert(Table::unique(params), "Two options of a StaticParser have the same name.");
+			static constexpr auto table = Table::hashed(params);
+			static constexpr auto details = Table::template details<Table::detailsLength(params)>(params);
+			array<priv::Slot,count> slots{};
+			Stats lastStats;
+		public:
+			// single values start from their defaults, lists are appended to like Parser does
+			void argparse(char** argv);
+			// the help text of argdetails(), a compile time constant
+			static constexpr string_view argdetails() { return string_view(details.data(), details.size()-1); }
+			const Stats& stats() const { return lastStats; } // of the last argparse, see PARAMS_STATS
+	};
+
+	// Options of a StaticParser, same signatures as the typed addp (but Buffer and span destinations).
+	constexpr StaticOption option(bool* _destination) { // for the help flag
+		return priv::makeOption(_destination, 1, false, "", "--help", "Prints this help message.");
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, 1, true, "", _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, int _xargs, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, _xargs, true, "", _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, const char* _defaultValue, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, 1, false, _defaultValue, _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, int _xargs, const char* _defaultValue, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, _xargs, false, _defaultValue, _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, bool _required, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, 1, _required, "", _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, int _xargs, bool _required, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, _xargs, _required, "", _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, const char* _defaultValue, bool _required, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, 1, _required, _defaultValue, _longPhrase, _helpPhrase);
+	}
+
+	template<typename T> constexpr StaticOption option(T* _destination, int _xargs, const char* _defaultValue, bool _required, const char* _longPhrase, const char* _helpPhrase) {
+		return priv::makeOption(_destination, _xargs, _required, _defaultValue, _longPhrase, _helpPhrase);
+	}
+
+	template<typename F> Option& Option::check(F predicate, string_view description) {
+		function<bool(const void*)> typed;
+		auto as = [&](auto* kind) {
+			typedef remove_const_t<remove_pointer_t<decltype(kind)>> T;
+			if constexpr (is_invocable_r<bool, F&, const T&>::value) {
+				typed = [predicate](const void* value) mutable { return bool(predicate(*static_cast<const T*>(value))); };
+			}
+		};
+		switch (param->type) {
+			case TYPE::BOOL: break;
+			case TYPE::INT: as((int*)nullptr); break;
+			case TYPE::UINT: as((unsigned int*)nullptr); break;
+			case TYPE::FLOAT: as((float*)nullptr); break;
+			case TYPE::LONG: as((long*)nullptr); break;
+			case TYPE::DOUBLE: as((double*)nullptr); break;
+			case TYPE::CHAR: as((char*)nullptr); break;
+			case TYPE::STRING: as((string_view*)nullptr); break;
+		}
+		if (!typed) {
+			priv::optionError("Option '%.*s' cannot be checked by a predicate which does not take its TYPE (a string_view for STRING).\n", param->longPhrase);
+		}
+		return check(move(typed), description);
+	}
+
+	template<typename T> const T* Result::get(string_view longPhrase) const {
+		if (registry == nullptr)
+			return nullptr;
+		const priv::Param* param = registry->index.find(longPhrase);
+		if (param == nullptr || param->ops != &priv::Binding<T>::ops)
+			return nullptr;
+		return static_cast<const T*>(slots[param->id].destination);
+	}
+
+	template<typename S, typename... M> void Parser::addFields(S& target, const Field<S,M>&... fields) {
+		auto add = [&](auto& field) {
+			priv::Param* param = registry.addTyped(&(target.*field.member), field.xargs, field.required, field.defaultValue, field.longPhrase, field.helpPhrase);
+			if (field.aliasName != nullptr) {
+				registry.alias(param, field.aliasName);
+			}
+		};
+		(add(fields), ...);
+	}
+
+	template<typename T> const T* View::get(string_view name) const {
+		static_assert(is_arithmetic<T>::value, "The string of a View is text(name).");
+		const priv::ViewEntry* entry = find(name, priv::TypeOf<T>::type, false);
+		return (entry != nullptr) ? reinterpret_cast<const T*>(block+entry->values) : nullptr;
+	}
+
+	template<typename T> ViewList<T> View::list(string_view name) const {
+		static_assert(!is_same<T,string>::value, "The strings of a View are string_view.");
+		ViewList<T> values;
+		TYPE type;
+		if constexpr (is_same<T,string_view>::value) {
+			type = TYPE::STRING;
+		} else {
+			type = priv::TypeOf<T>::type;
+		}
+		const priv::ViewEntry* entry = find(name, type, true);
+		if (entry != nullptr) {
+			values.block = block;
+			values.values = block+entry->values;
+			values.count = size_t(entry->count);
+		}
+		return values;
+	}
+
+#if PARAMS_DEFINE
+	namespace priv {
+		PARAMS_API void optionError(const char* message, string_view longPhrase) {
+			fprintf(stderr, message, int(longPhrase.size()), longPhrase.data());
+			exit(1);
+		}
+	}
+
+	PARAMS_API Option& Option::delimiter(char separator) {
+		if (!param->list || strchr(" =\"\\@\n\t\r", separator) != nullptr) { // also rejects '\0'
+			fprintf(stderr, "Option '%.*s' cannot take '%c' as a delimiter, only lists take one and it must not be a separator, quote or escape.\n", int(param->longPhrase.size()), param->longPhrase.data(), separator);
+			exit(1);
+		}
+		param->delimiter = separator;
+		return *this;
+	}
+
+	PARAMS_API Option& Option::parallel(unsigned threads) {
+		if (!param->list || param->ops->bulk == nullptr) {
+			fprintf(stderr, "Option '%.*s' cannot be converted in parallel, only numeric lists can.\n", int(param->longPhrase.size()), param->longPhrase.data());
+			exit(1);
+		}
+		param->threads = threads;
+		return *this;
+	}
+
+	PARAMS_API Option& Option::alias(string_view name) {
+		registry->alias(param, name);
+		return *this;
+	}
+
+	PARAMS_API priv::Constraint& Option::constraint() {
+		if (param->constraint == nullptr) {
+			param->constraint = registry->arena.make<priv::Constraint>();
+		}
+		return *param->constraint;
+	}
+
+	PARAMS_API Option& Option::constrained() {
+		static atomic<size_t> serials{0};
+		priv::Constraint& limits = *param->constraint;
+		limits.serial = serials.fetch_add(1)+1; // a Lazy filled before keeps a copy of the old one
+		vector<string> pieces;
+		if (limits.bounded) {
+			char low[32] = {}, high[32] = {};
+			if (param->type == TYPE::FLOAT || param->type == TYPE::DOUBLE) {
+				to_chars(low, low+sizeof(low)-1, limits.low);
+				to_chars(high, high+sizeof(high)-1, limits.high);
+			} else {
+				to_chars(low, low+sizeof(low)-1, limits.lowInteger);
+				to_chars(high, high+sizeof(high)-1, limits.highInteger);
+			}
+			pieces.push_back(string("from ")+low+" to "+high);
+		}
+		if (!limits.choices.empty()) {
+			string piece = "one of:";
+			for (string_view choice : limits.choices) {
+				piece += (piece.back() == ':') ? " " : ", ";
+				piece += choice;
+			}
+			pieces.push_back(piece);
+		}
+		if (limits.predicate) {
+			pieces.push_back("must be "+string(limits.described));
+		}
+		string rule, help;
+		for (const string& piece : pieces) {
+			rule += rule.empty() ? "" : "; ";
+			rule += piece;
+			help += "\n\t\t";
+			help += piece;
+		}
+		limits.rule = registry->arena.copy(rule);
+		limits.help = registry->arena.copy(help);
+		++registry->generation; // for the help text
+		if (!param->list) {
+			param->SetDefault(param->destination); // exits if the default is not allowed
+		}
+		return *this;
+	}
+
+	PARAMS_API Option& Option::range(priv::Bound low, priv::Bound high) {
+		bool ordered = (low.integral && high.integral) ? low.integer <= high.integer : low.real <= high.real;
+		if (param->type == TYPE::BOOL || param->type == TYPE::CHAR || param->type == TYPE::STRING || !ordered) {
+			priv::optionError("Option '%.*s' cannot take this range, only numeric options take one and low must not exceed high.\n", param->longPhrase);
+		}
+		// a real bound of an integer option, rounded inwards and clamped to long long
+		auto integer = [](const priv::Bound& bound, bool upper) {
+			if (bound.integral)
+				return bound.integer;
+			double rounded = upper ? floor(bound.real) : ceil(bound.real);
+			if (rounded >= 9223372036854775808.0)
+				return LLONG_MAX;
+			if (rounded < -9223372036854775808.0)
+				return LLONG_MIN;
+			return (long long)rounded;
+		};
+		priv::Constraint& limits = constraint();
+		limits.bounded = true;
+		limits.low = low.real;
+		limits.high = high.real;
+		limits.lowInteger = integer(low, false);
+		limits.highInteger = integer(high, true);
+		return constrained();
+	}
+
+	PARAMS_API Option& Option::choices(initializer_list<string_view> allowed) {
+		if (param->type != TYPE::CHAR && param->type != TYPE::STRING) {
+			priv::optionError("Option '%.*s' cannot take choices, only STRING and CHAR options take them.\n", param->longPhrase);
+		}
+		priv::Constraint& limits = constraint();
+		limits.choices.clear();
+		for (string_view choice : allowed) {
+			if (param->type == TYPE::CHAR && choice.size() != 1) {
+				priv::optionError("Option '%.*s' is a CHAR, its choices must be one character each.\n", param->longPhrase);
+			}
+			limits.choices.push_back(registry->arena.copy(choice));
+		}
+		return constrained();
+	}
+
+	// a second predicate is checked after the first
+	PARAMS_API Option& Option::check(function<bool(const void*)> predicate, string_view description) {
+		priv::Constraint& limits = constraint();
+		if (limits.predicate) {
+			limits.predicate = [first = move(limits.predicate), second = move(predicate)](const void* value) { return first(value) && second(value); };
+			limits.described = registry->arena.copy(string(limits.described)+" and "+string(description));
+		} else {
+			limits.predicate = move(predicate);
+			limits.described = registry->arena.copy(description);
+		}
+		return constrained();
+	}
+
+	PARAMS_API void Parser::argparse(char** argv) {
+		Sources sources;
+		sources.argv = argv;
+		argparse(sources);
+	}
+
+	PARAMS_API void Parser::argparse(const Sources& sources) {
+		park();
+		registry.prepare();
+		PARAMS_STAT(size_t capacity = slots.capacity();)
+		priv::bindSlots(registry, slots, 0);
+		string failedText;
+		auto command = [&](string_view name) {
+			size_t first = registry.params.size();
+			if (!pick(name))
+				return false;
+			registry.prepare();
+			priv::bindSlots(registry, slots, first);
+			return true;
+		};
+		priv::Outcome outcome = priv::parseSources(registry, sources, slots, lastStats, failedText, command);
+		PARAMS_STAT(lastStats.allocations += (slots.capacity() != capacity);)
+		if (outcome.failure != Failure::NONE) {
+			fprintf(stderr, "%s\n", priv::describe(outcome).c_str());
+			exit(1);
+		}
+	}
+
+	PARAMS_API Error Parser::tryparse(char** argv) {
+		Sources sources;
+		sources.argv = argv;
+		return tryparse(sources);
+	}
+
+	PARAMS_API Error Parser::tryparse(const Sources& sources) {
+		park();
+		registry.prepare();
+		vector<priv::Slot> staged;
+		auto stage = [&](size_t first) {
+			staged.resize(registry.params.size());
+			for (size_t id=first; id<staged.size(); ++id) {
+				const priv::Param* param = registry.params[id];
+				staged[id] = priv::Slot{param, param->ops->stage(param->destination), 0, param->type == TYPE::BOOL};
+			}
+		};
+		stage(0);
+		string failedText;
+		auto command = [&](string_view name) {
+			size_t first = registry.params.size();
+			if (!pick(name))
+				return false;
+			registry.prepare();
+			stage(first);
+			return true;
+		};
+		priv::Outcome outcome = priv::parseSources(registry, sources, staged, lastStats, failedText, command);
+		PARAMS_STAT(lastStats.allocations += 1 + staged.size();) // the slots and the staged values
+		Error error;
+		if (outcome.failure == Failure::NONE) {
+			for (priv::Slot& slot : staged) {
+				slot.param->ops->commit(slot.param->destination, slot.destination);
+			}
+		} else {
+			error.code = outcome.failure;
+			error.option = (outcome.param != nullptr) ? outcome.param->longPhrase : string_view();
+			error.token = outcome.token;
+			lastError = priv::describe(outcome);
+		}
+		for (priv::Slot& slot : staged) {
+			slot.param->ops->destroy(slot.destination);
+		}
+		return error;
+	}
+
+	PARAMS_API Schema Parser::compile() const {
+		return Schema(*this);
+	}
+
+	PARAMS_API Result::Result(Result&& other) noexcept : registry(other.registry), slots(move(other.slots)), message(move(other.message)), help(other.help), parseStats(other.parseStats) {
+		other.slots.clear();
+	}
+
+	PARAMS_API Result& Result::operator=(Result&& other) noexcept {
+		if (this != &other) {
+			release();
+			registry = other.registry;
+			slots = move(other.slots);
+			message = move(other.message);
+			help = other.help;
+			parseStats = other.parseStats;
+			other.slots.clear();
+		}
+		return *this;
+	}
+
+	PARAMS_API Result::~Result() {
+		release();
+	}
+
+	PARAMS_API void Result::release() {
+		for (priv::Slot& slot : slots) {
+			slot.param->ops->destroy(slot.destination);
+		}
+		slots.clear();
+	}
+
+	PARAMS_API Schema::Schema(const Parser& parser) {
+		for (const priv::Param* param : parser.registry.params) {
+			void* prototype = param->ops->create(param->destination); // the size of a fixed count destination
+			priv::Param* copy = registry.add(param->type, param->ops, param->list, prototype, param->xargs, param->required, param->defaultValue, param->longPhrase, param->helpPhrase);
+			copy->delimiter = param->delimiter;
+			copy->threads = param->threads;
+			if (param->constraint != nullptr) { // with its strings in this registry
+				priv::Constraint* limits = registry.arena.make<priv::Constraint>(*param->constraint);
+				for (string_view& choice : limits->choices) {
+					choice = registry.arena.copy(choice);
+				}
+				limits->described = registry.arena.copy(limits->described);
+				limits->rule = registry.arena.copy(limits->rule);
+				limits->help = registry.arena.copy(limits->help);
+				copy->constraint = limits;
+			}
+			for (const priv::Alias* alias = param->aliases; alias != nullptr; alias = alias->next) {
+				registry.alias(copy, alias->name);
+			}
+		}
+		registry.prefixes = parser.registry.prefixes;
+		registry.prepare();
+	}
+
+	PARAMS_API Schema::~Schema() {
+		for (const priv::Param* param : registry.params) {
+			param->ops->destroy(param->destination);
+		}
+	}
+
+	PARAMS_API Result Schema::parse(char** argv) const {
+		priv::Tokenizer tokens(argv);
+		return parseFrom(tokens);
+	}
+
+	PARAMS_API Result Schema::parseConfig(string_view text) const {
+		priv::Tokenizer tokens(text);
+		return parseFrom(tokens);
+	}
+
+	PARAMS_API Result Schema::parseFrom(priv::Tokenizer& tokens) const {
+		Result result;
+		result.registry = &registry;
+		result.slots.resize(registry.params.size());
+		for (const priv::Param* param : registry.params) {
+			void* value = param->ops->create(param->destination);
+			param->SetDefault(value);
+			result.slots[param->id] = priv::Slot{param, value, 0, param->type == TYPE::BOOL};
+		}
+		priv::Outcome outcome = priv::parseAll(registry, tokens, result.slots.data(), result.slots.size(), result.parseStats);
+		PARAMS_STAT(result.parseStats.allocations += 1 + result.slots.size();) // the slots and the values
+		result.message = priv::describe(outcome);
+		result.help = outcome.help;
+		return result;
+	}
+
+	PARAMS_API vector<Result> Schema::parse(const vector<char**>& batch, unsigned threads) const {
+		vector<Result> results(batch.size());
+		auto work = [&](size_t begin, size_t end) {
+			for (size_t i=begin; i<end; ++i) {
+				results[i] = parse(batch[i]);
+			}
+		};
+		if (threads == 0) {
+			threads = priv::Workers::cores();
+		}
+		size_t chunk = (batch.size() + threads-1) / threads;
+		vector<thread> workers;
+		for (size_t begin=chunk; begin < batch.size(); begin += chunk) {
+			workers.emplace_back(work, begin, min(begin+chunk, batch.size()));
+		}
+		work(0, min(chunk, batch.size()));
+		for (thread& worker : workers) {
+			worker.join();
+		}
+		return results;
+	}
+
+#endif
+
+	template<const auto& Options> void StaticParser<Options>::argparse(char** argv) {
+		for (const StaticOption& param : params) {
+			param.SetDefault(param.destination);
+			slots[param.id] = priv::Slot{&param, param.destination, 0, param.type == TYPE::BOOL};
+		}
+		priv::StaticNames names{params.data(), table.data(), table.size()-1};
+		priv::Tokenizer tokens(argv);
+		priv::Outcome outcome = priv::parseAll(names, tokens, slots.data(), count, lastStats);
+		if (outcome.failure != Failure::NONE) {
+			fprintf(stderr, "%s\n", priv::describe(outcome).c_str());
+			exit(1);
+		}
+	}
+
+
+#if PARAMS_DEFINE
+	namespace priv {
+#if PARAMS_HAVE_MMAP
+		PARAMS_API bool stampFile(const char* path, FileStamp& stamp) {
+			struct stat info;
+			if (stat(path, &info) != 0)
+				return false;
+#if defined(__APPLE__)
+			long long nanoseconds = info.st_mtimespec.tv_nsec;
+#else
+			long long nanoseconds = info.st_mtim.tv_nsec;
+#endif
+			stamp = FileStamp{{(long long)info.st_size, (long long)info.st_mtime, nanoseconds, (long long)info.st_ino, (long long)info.st_dev}};
+			return true;
+		}
+#else
+		PARAMS_API bool stampFile(const char*, FileStamp&) {
+			return false;
+		}
+#endif
+
+		PARAMS_API bool readFile(const char* path, string& contents) {
+			FILE* stream = fopen(path, "rb");
+			if (stream == nullptr)
+				return false;
+			char buffer[65536];
+			size_t count;
+			while ((count = fread(buffer, 1, sizeof(buffer), stream)) > 0) {
+				contents.append(buffer, count);
+			}
+			bool good = !ferror(stream);
+			fclose(stream);
+			return good;
+		}
+	}
+
+	namespace priv {
+		static const char cacheMagic[8] = {'P', 'A', 'R', 'A', 'M', 'S', 'C', '\n'};
+		static const uint32_t cacheVersion = 2;
+
+		// 64 bit hash taking 8 bytes per step, for cache keys and checksums of large values
+		PARAMS_API uint64_t hashBytes(const void* data, size_t size, uint64_t h) {
+			const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+			const char* bytes = static_cast<const char*>(data);
+			for (; size >= 8; bytes += 8, size -= 8) {
+				uint64_t word;
+				memcpy(&word, bytes, 8);
+				h = (h ^ word) * multiplier;
+				h ^= h >> 29;
+			}
+			uint64_t tail = uint64_t(size) << 56;
+			if (size != 0) {
+				memcpy(&tail, bytes, size);
+			}
+			h = (h ^ tail) * multiplier;
+			return h ^ (h >> 32);
+		}
+
+		// Hash of the machine's type sizes and every option (its name, TYPE, count, default, delimiter).
+		PARAMS_API uint64_t optionsKey(const Registry& registry) {
+			const uint64_t shape[] = {cacheVersion, sizeof(int), sizeof(long), sizeof(float), sizeof(double), sizeof(bool), registry.prefixes};
+			uint64_t h = hashBytes(shape, sizeof(shape), 0);
+			auto text = [&](string_view piece) {
+				uint64_t size = piece.size();
+				h = hashBytes(&size, sizeof(size), h);
+				h = hashBytes(piece.data(), piece.size(), h);
+			};
+			for (const Param* param : registry.params) {
+				text(param->longPhrase);
+				text(param->defaultValue);
+				text((param->constraint != nullptr) ? param->constraint->rule : string_view()); // ranges and choices, predicates are not cached
+				for (const Alias* alias = param->aliases; alias != nullptr; alias = alias->next) {
+					text(alias->name);
+				}
+				const int64_t fields[] = {int64_t(param->type), param->xargs, param->required, param->list, param->delimiter};
+				h = hashBytes(fields, sizeof(fields), h);
+			}
+			return h;
+		}
+
+		// Hash of everything the values follow from: the options, see optionsKey, and the argv entries.
+		// A response file is stood in for by its stat stamp (size, time, inode), or its contents where stat
+		// is not available.
+		PARAMS_API uint64_t cacheKey(const Registry& registry, char** argv) {
+			uint64_t h = optionsKey(registry);
+			auto text = [&](string_view piece) {
+				uint64_t size = piece.size();
+				h = hashBytes(&size, sizeof(size), h);
+				h = hashBytes(piece.data(), piece.size(), h);
+			};
+			for (char** entry = (*argv != nullptr) ? argv+1 : argv; *entry != nullptr; ++entry) {
+				string_view word(*entry);
+				text(word);
+				for (size_t at = word.find('@'); at != string_view::npos; at = word.find('@', at+1)) {
+					if (at != 0 && word[at-1] != ' ' && word[at-1] != '=')
+						continue; // not where a token starts
+					string path(word.substr(at+1, word.find_first_of(" =", at+1)-(at+1)));
+					FileStamp stamp;
+					string contents;
+					if (stampFile(path.c_str(), stamp)) {
+						h = hashBytes(&stamp, sizeof(stamp), h);
+					} else if (readFile(path.c_str(), contents)) {
+						text(contents);
+					}
+				}
+			}
+			return h;
+		}
+
+		PARAMS_API bool cacheable(const Registry& registry, char** argv) {
+			for (const Param* param : registry.params) {
+				if (param->ops->save == nullptr || (param->constraint != nullptr && param->constraint->predicate))
+					return false;
+			}
+			for (char** entry = (*argv != nullptr) ? argv+1 : argv; *entry != nullptr; ++entry) {
+				string_view word(*entry);
+				for (size_t at = word.find("@-"); at != string_view::npos; at = word.find("@-", at+1)) {
+					bool starts = (at == 0 || word[at-1] == ' ' || word[at-1] == '=');
+					bool ends = (at+2 == word.size() || word[at+2] == ' ' || word[at+2] == '=');
+					if (starts && ends)
+						return false;
+				}
+			}
+			return true;
+		}
+
+		PARAMS_API bool cachedCommand(uint64_t key, const char* path, uint64_t& command) {
+			CacheHeader header;
+			FILE* stream = fopen(path, "rb");
+			if (stream == nullptr)
+				return false;
+			bool read = fread(&header, sizeof(header), 1, stream) == 1;
+			fclose(stream);
+			if (!read || memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion || header.byteOrder != 0x01020304 || header.key != key)
+				return false;
+			command = header.command;
+			return true;
+		}
+
+		PARAMS_API bool loadCache(const Registry& registry, uint64_t key, uint64_t options, const char* path) {
+			MappedFile file;
+			if (!file.open(path))
+				return false;
+			size_t size = size_t(file.end()-file.begin());
+			CacheHeader header;
+			if (size < sizeof(header))
+				return false;
+			memcpy(&header, file.begin(), sizeof(header));
+			if (memcmp(header.magic, cacheMagic, sizeof(cacheMagic)) != 0 || header.version != cacheVersion || header.byteOrder != 0x01020304
+					|| header.key != key || header.options != options || header.count != registry.params.size() || header.length != size-sizeof(header))
+				return false;
+			string_view records(file.begin()+sizeof(header), size-sizeof(header));
+			if (hashBytes(records.data(), records.size(), key) != header.checksum)
+				return false;
+			// checked in full first, so a cache which does not fit the variables leaves them alone
+			for (bool write : {false, true}) {
+				string_view rest = records;
+				for (const Param* param : registry.params) {
+					if (rest.empty())
+						return false;
+					bool written = rest[0] != 0;
+					rest.remove_prefix(1);
+					if (!written)
+						continue;
+					uint64_t length;
+					if (rest.size() < sizeof(length))
+						return false;
+					memcpy(&length, rest.data(), sizeof(length));
+					rest.remove_prefix(sizeof(length));
+					if (rest.size() < length || !param->ops->load(param->destination, rest.substr(0, size_t(length)), write))
+						return false;
+					rest.remove_prefix(size_t(length));
+				}
+				if (!rest.empty())
+					return false;
+			}
+			return true;
+		}
+
+		// Writes what the parse into slots wrote: flags, single values given, lists from their length before
+		// the parse on (Slot::kept), and fixed count lists given or default filled. Replaces the file atomically.
+		PARAMS_API bool saveCache(const Registry& registry, const vector<Slot>& slots, uint64_t key, uint64_t command, const char* path) {
+			string out(sizeof(CacheHeader), '\0');
+			for (const Param* param : registry.params) {
+				const Slot& slot = slots[param->id];
+				bool written = param->type == TYPE::BOOL || slot.xargsRead > 0 || (param->list && param->xargs > slot.xargsRead && param->defaultValue != "");
+				out += char(written);
+				if (!written)
+					continue;
+				size_t at = out.size();
+				uint64_t length = 0;
+				out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+				param->ops->save(param->destination, slot.kept, out);
+				length = out.size()-at-sizeof(length);
+				memcpy(&out[at], &length, sizeof(length));
+			}
+			CacheHeader header;
+			memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+			header.version = cacheVersion;
+			header.byteOrder = 0x01020304;
+			header.key = key;
+			header.command = command;
+			header.options = optionsKey(registry);
+			header.count = registry.params.size();
+			header.length = out.size()-sizeof(header);
+			header.checksum = hashBytes(out.data()+sizeof(header), out.size()-sizeof(header), key);
+			memcpy(&out[0], &header, sizeof(header));
+#if PARAMS_HAVE_MMAP
+			string temporary = string(path)+"."+to_string(getpid()); // processes writing the same cache do not mix
+#else
+			string temporary = string(path)+".tmp";
+#endif
+			FILE* stream = fopen(temporary.c_str(), "wb");
+			if (stream == nullptr)
+				return false;
+			bool good = fwrite(out.data(), 1, out.size(), stream) == out.size();
+			good = (fclose(stream) == 0) && good;
+			if (!good || rename(temporary.c_str(), path) != 0) {
+				remove(temporary.c_str());
+				return false;
+			}
+			return true;
+		}
+
+		inline size_t typeSize(TYPE type) {
+			switch (type) {
+				case TYPE::BOOL: return sizeof(bool);
+				case TYPE::INT: return sizeof(int);
+				case TYPE::UINT: return sizeof(unsigned int);
+				case TYPE::FLOAT: return sizeof(float);
+				case TYPE::LONG: return sizeof(long);
+				case TYPE::DOUBLE: return sizeof(double);
+				case TYPE::CHAR: return sizeof(char);
+				default: return 0; // strings have offsets
+			}
+		}
+
+		static const char viewMagic[8] = {'P', 'A', 'R', 'A', 'M', 'S', 'V', '\n'};
+		static const uint32_t viewVersion = 1;
+
+		inline uint64_t viewShape() {
+			const uint64_t shape[] = {viewVersion, sizeof(int), sizeof(long), sizeof(float), sizeof(double), sizeof(bool)};
+			return hashBytes(shape, sizeof(shape), 0);
+		}
+
+		// The values are encoded by Ops::save like a cache record, strings then get their offsets.
+		PARAMS_API string publishBlock(const Registry& registry) {
+			struct Named {
+				string_view name;
+				const Param* param;
+			};
+			vector<Named> names;
+			for (const Param* param : registry.params) {
+				if (param->ops->save == nullptr)
+					continue; // a Sink or a Lazy
+				names.push_back(Named{param->longPhrase, param});
+				for (const Alias* alias = param->aliases; alias != nullptr; alias = alias->next) {
+					names.push_back(Named{alias->name, param});
+				}
+			}
+			sort(names.begin(), names.end(), [](const Named& a, const Named& b) { return a.name < b.name; });
+			vector<ViewEntry> entries(names.size());
+			string out(sizeof(ViewHeader)+names.size()*sizeof(ViewEntry), '\0');
+			for (size_t i=0; i<names.size(); ++i) {
+				entries[i].name = out.size();
+				entries[i].nameLength = names[i].name.size();
+				out += names[i].name;
+			}
+			auto align = [&]() { out.resize((out.size()+7) & ~size_t(7), '\0'); };
+			vector<size_t> written(registry.params.size(), SIZE_MAX); // entry by id whose values are in place
+			string encoded;
+			for (size_t i=0; i<names.size(); ++i) {
+				const Param* param = names[i].param;
+				ViewEntry& entry = entries[i];
+				entry.type = uint32_t(param->type);
+				entry.list = param->list;
+				if (written[param->id] != SIZE_MAX) { // an alias
+					entry.values = entries[written[param->id]].values;
+					entry.count = entries[written[param->id]].count;
+					continue;
+				}
+				written[param->id] = i;
+				encoded.clear();
+				param->ops->save(param->destination, 0, encoded);
+				align();
+				entry.values = out.size();
+				if (param->type == TYPE::STRING) {
+					vector<string_view> texts;
+					if (param->list) {
+						string_view rest = encoded, text;
+						while (decodeString(rest, text)) {
+							texts.push_back(text);
+						}
+					} else {
+						texts.push_back(encoded);
+					}
+					entry.count = texts.size();
+					uint64_t offset = out.size()+(texts.size()+1)*sizeof(uint64_t);
+					for (size_t t=0; t<=texts.size(); ++t) {
+						out.append(reinterpret_cast<const char*>(&offset), sizeof(offset));
+						offset += (t < texts.size()) ? texts[t].size() : 0;
+					}
+					for (string_view text : texts) {
+						out += text;
+					}
+				} else {
+					entry.count = encoded.size()/typeSize(param->type);
+					out += encoded;
+				}
+			}
+			align();
+			ViewHeader header;
+			memcpy(header.magic, viewMagic, sizeof(viewMagic));
+			header.version = viewVersion;
+			header.byteOrder = 0x01020304;
+			header.shape = viewShape();
+			header.count = entries.size();
+			header.length = out.size();
+			memcpy(&out[0], &header, sizeof(header));
+			if (!entries.empty()) {
+				memcpy(&out[sizeof(header)], entries.data(), entries.size()*sizeof(ViewEntry));
+			}
+			return out;
+		}
+
+		// everything a View reads lies inside the block, checked once when it is mapped
+		PARAMS_API bool checkBlock(const char* block, size_t length) {
+			ViewHeader header;
+			if (length < sizeof(header))
+				return false;
+			memcpy(&header, block, sizeof(header));
+			if (memcmp(header.magic, viewMagic, sizeof(viewMagic)) != 0 || header.version != viewVersion || header.byteOrder != 0x01020304
+					|| header.shape != viewShape() || header.length != length || header.count > (length-sizeof(header))/sizeof(ViewEntry))
+				return false;
+			const ViewEntry* entries = reinterpret_cast<const ViewEntry*>(block+sizeof(header));
+			auto inside = [&](uint64_t offset, uint64_t bytes) { return offset <= length && bytes <= length-offset; };
+			for (uint64_t i=0; i<header.count; ++i) {
+				const ViewEntry& entry = entries[i];
+				if (!inside(entry.name, entry.nameLength) || entry.type > uint32_t(TYPE::STRING) || entry.values % 8 != 0)
+					return false;
+				if (entry.type != uint32_t(TYPE::STRING)) {
+					if (entry.count > length/typeSize(TYPE(entry.type)) || !inside(entry.values, entry.count*typeSize(TYPE(entry.type))))
+						return false;
+					continue;
+				}
+				if (entry.count >= length/sizeof(uint64_t) || !inside(entry.values, (entry.count+1)*sizeof(uint64_t)))
+					return false;
+				const uint64_t* offsets = reinterpret_cast<const uint64_t*>(block+entry.values);
+				for (uint64_t t=0; t<entry.count; ++t) {
+					if (offsets[t] > offsets[t+1] || !inside(offsets[t], offsets[t+1]-offsets[t]))
+						return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	PARAMS_API View::View(int fd) {
+#if PARAMS_HAVE_MMAP
+		struct stat status;
+		if (fstat(fd, &status) != 0 || status.st_size <= 0)
+			return;
+		void* mapped = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		if (mapped == MAP_FAILED)
+			return;
+		if (!priv::checkBlock(static_cast<const char*>(mapped), size_t(status.st_size)) || (descriptor = dup(fd)) < 0) {
+			munmap(mapped, size_t(status.st_size));
+			return;
+		}
+		block = static_cast<const char*>(mapped);
+		length = size_t(status.st_size);
+#else
+		(void)fd;
+#endif
+	}
+
+	PARAMS_API View::View(View&& other) noexcept : block(other.block), length(other.length), descriptor(other.descriptor) {
+		other.block = nullptr;
+		other.length = 0;
+		other.descriptor = -1;
+	}
+
+	PARAMS_API View& View::operator=(View&& other) noexcept {
+		swap(block, other.block);
+		swap(length, other.length);
+		swap(descriptor, other.descriptor);
+		return *this;
+	}
+
+	PARAMS_API View::~View() {
+#if PARAMS_HAVE_MMAP
+		if (block != nullptr) {
+			munmap(const_cast<char*>(block), length);
+			close(descriptor);
+		}
+#endif
+	}
+
+	PARAMS_API const priv::ViewEntry* View::find(string_view name, TYPE type, bool list) const {
+		if (block == nullptr)
+			return nullptr;
+		priv::ViewHeader header;
+		memcpy(&header, block, sizeof(header));
+		const priv::ViewEntry* entries = reinterpret_cast<const priv::ViewEntry*>(block+sizeof(header));
+		const priv::ViewEntry* entry = lower_bound(entries, entries+header.count, name, [this](const priv::ViewEntry& e, string_view n) {
+			return string_view(block+e.name, size_t(e.nameLength)) < n;
+		});
+		if (entry == entries+header.count || string_view(block+entry->name, size_t(entry->nameLength)) != name
+				|| entry->type != uint32_t(type) || (entry->list != 0) != list)
+			return nullptr;
+		return entry;
+	}
+
+	PARAMS_API string_view View::text(string_view name) const {
+		const priv::ViewEntry* entry = find(name, TYPE::STRING, false);
+		if (entry == nullptr)
+			return string_view();
+		const uint64_t* offsets = reinterpret_cast<const uint64_t*>(block+entry->values);
+		return string_view(block+offsets[0], size_t(offsets[1]-offsets[0]));
+	}
+
+	// Written into an anonymous shared memory file (a sealed memfd on Linux, an unlinked POSIX shm
+	// elsewhere), which is then mapped read only like any other.
+	PARAMS_API View Parser::publish() const {
+#if PARAMS_HAVE_MMAP
+		string block = priv::publishBlock(registry);
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+		int fd = memfd_create("params", MFD_ALLOW_SEALING);
+#else
+		static atomic<unsigned> published{0};
+		string name = "/params."+to_string(getpid())+"."+to_string(published.fetch_add(1));
+		int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+		if (fd >= 0) {
+			shm_unlink(name.c_str());
+		}
+#endif
+		if (fd < 0)
+			return View();
+		bool good = ftruncate(fd, off_t(block.size())) == 0;
+		void* mapped = good ? mmap(nullptr, block.size(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+		if (mapped != MAP_FAILED) {
+			memcpy(mapped, block.data(), block.size());
+			munmap(mapped, block.size());
+		}
+#if defined(__linux__) && defined(MFD_ALLOW_SEALING)
+		if (mapped != MAP_FAILED) { // no one can change it under the readers
+			fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+		}
+#endif
+		View view;
+		if (mapped != MAP_FAILED) {
+			view = View(fd);
+		}
+		close(fd);
+		return view;
+#else
+		return View();
+#endif
+	}
+
+	PARAMS_API bool Parser::argparse(char** argv, const char* cachePath) {
+		Sources sources;
+		sources.argv = argv;
+		park();
+		registry.prepare();
+		if (cachePath == nullptr || !priv::cacheable(registry, argv)) {
+			argparse(sources);
+			return false;
+		}
+		uint64_t key = priv::cacheKey(registry, argv); // the command follows from these options and argv
+		uint64_t command = 0;
+		if (priv::cachedCommand(key, cachePath, command) && (command == 0 || (command <= commands.size() && pick(commands[size_t(command-1)].name)))) {
+			registry.prepare();
+			if (priv::loadCache(registry, key, priv::optionsKey(registry), cachePath)) {
+				lastStats = Stats();
+				return true;
+			}
+		}
+		argparse(sources);
+		if (priv::cacheable(registry, argv)) { // also with the options of the command
+			priv::saveCache(registry, slots, key, (active != SIZE_MAX) ? active+1 : 0, cachePath); // if it fails the next run parses again
+		}
+		return false;
+	}
+
+	namespace priv {
+		struct Watch {
+			mutex reloading; // held by whoever parses the file, readers never take it
+			thread watcher;
+			mutex waiting;
+			condition_variable wake;
+			bool stopping = false;
+		};
+	}
+
+	PARAMS_API Reloader::Reloader(const Schema& _schema, string _path) : schema(_schema), path(move(_path)), watching(make_unique<priv::Watch>()) {
+		update(true);
+	}
+
+	PARAMS_API Reloader::~Reloader() {
+		stop();
+	}
+
+	PARAMS_API bool Reloader::update(bool force) {
+		lock_guard<mutex> lock(watching->reloading);
+		priv::FileStamp before, after;
+		bool stamped = priv::stampFile(path.c_str(), before);
+		if (stamped && !force && before == stamp)
+			return false; // unchanged
+		// the file is read rather than mapped, as it may be rewritten meanwhile
+		string text;
+		if (!priv::readFile(path.c_str(), text)) {
+			lastError = "Could not read config file '"+path+"'.";
+			return false;
+		}
+		if (stamped && (!priv::stampFile(path.c_str(), after) || after != before))
+			return false; // changed while reading, the next poll sees it settled
+		Result result = schema.parseConfig(text);
+		stamp = before;
+		if (!result.ok()) {
+			lastError = result.error();
+			return false;
+		}
+		lastError.clear();
+		publish(move(result));
+		return true;
+	}
+
+	PARAMS_API void Reloader::publish(Result&& result) {
+		priv::Published* retired = current.load();
+		priv::Published* next = nullptr;
+		for (unique_ptr<priv::Published>& candidate : published) {
+			if (candidate.get() != retired && candidate->pins.load() == 0) {
+				next = candidate.get();
+				break;
+			}
+		}
+		if (next == nullptr) {
+			published.push_back(make_unique<priv::Published>());
+			next = published.back().get();
+		}
+		next->result = move(result);
+		next->version = ++version;
+		current.store(next);
+		// A reader pinning an older one from now on finds it is not current and lets go
+		// without looking inside, so the unpinned ones can release their values.
+		for (unique_ptr<priv::Published>& candidate : published) {
+			if (candidate.get() != next && candidate->pins.load() == 0) {
+				candidate->result = Result();
+			}
+		}
+	}
+
+	PARAMS_API Snapshot Reloader::snapshot() const {
+		while (true) {
+			priv::Published* latest = current.load();
+			if (latest == nullptr)
+				return Snapshot();
+			latest->pins.fetch_add(1);
+			if (current.load() == latest)
+				return Snapshot(latest);
+			latest->pins.fetch_sub(1); // replaced meanwhile, try the new one
+		}
+	}
+
+	PARAMS_API string Reloader::error() const {
+		lock_guard<mutex> lock(watching->reloading);
+		return lastError;
+	}
+
+	PARAMS_API void Reloader::watch(chrono::milliseconds interval) {
+		stop();
+		priv::Watch& state = *watching;
+		state.stopping = false;
+		state.watcher = thread([this, &state, interval]() {
+			unique_lock<mutex> lock(state.waiting);
+			while (!state.wake.wait_for(lock, interval, [&state]() { return state.stopping; })) {
+				lock.unlock();
+				update(false);
+				lock.lock();
+			}
+		});
+	}
+
+	PARAMS_API void Reloader::stop() {
+		priv::Watch& state = *watching;
+		if (!state.watcher.joinable())
+			return;
+		{
+			lock_guard<mutex> lock(state.waiting);
+			state.stopping = true;
+		}
+		state.wake.notify_all();
+		state.watcher.join();
+	}
+
+	PARAMS_API void Parser::reset() {
+		registry.clear();
+		commands.clear();
+		active = SIZE_MAX;
+		setUp = SIZE_MAX;
+		commandParams.clear();
+	}
+
+	PARAMS_API void Parser::command(string name, string helpPhrase, function<void(Parser&)> setup) {
+		for (const Command& command : commands) {
+			if (command.name == name) {
+				fprintf(stderr, "Command '%s' cannot be registered twice.\n", name.c_str());
+				exit(1);
+			}
+		}
+		commands.push_back(Command{move(name), move(helpPhrase), move(setup)});
+		++registry.generation; // for the help text
+	}
+
+	// A parse starts without the options of any command, and the first argv token (after response files
+	// are expanded and quoted values joined) which is neither an option nor a value picks one, see parseSources.
+	// Its options are kept when another parse does not pick it, and registered again if a later one does.
+	PARAMS_API void Parser::park() {
+		if (active != SIZE_MAX) {
+			registry.drop(commandParams);
+			active = SIZE_MAX;
+		}
+	}
+
+	PARAMS_API bool Parser::pick(string_view name) {
+		if (active != SIZE_MAX)
+			return false; // a single command per parse
+		size_t picked = 0;
+		while (picked < commands.size() && commands[picked].name != name) {
+			++picked;
+		}
+		if (picked == commands.size())
+			return false;
+		if (picked == setUp) {
+			registry.restore(commandParams);
+		} else {
+			size_t first = registry.params.size();
+			function<void(Parser&)> setup = commands[picked].setup; // which may register more commands
+			registry.replaces = false; // an option registered directly cannot be replaced, it must outlive the command
+			setup(*this);
+			registry.replaces = true;
+			commandParams.assign(registry.params.begin()+first, registry.params.end());
+			setUp = picked;
+		}
+		active = picked;
+		return true;
+	}
+
+	template<typename Output> void Parser::render(Output&& output) const {
+		priv::renderDetails(registry, output);
+		for (const Command& command : commands) {
+			output("\t");
+			output(command.name);
+			output("\n\t\t");
+			if (!command.helpPhrase.empty()) {
+				output(command.helpPhrase);
+				output("\n\t\t");
+			}
+			output("a command with options of its own, see ");
+			output(command.name);
+			output(" --help\n");
+		}
+	}
+
+	PARAMS_API const string& Parser::argdetails() {
+		if (detailsGeneration != registry.generation) {
+			size_t length = 0;
+			render([&](string_view piece) { length += piece.size(); });
+			details.clear();
+			details.reserve(length);
+			render([&](string_view piece) { details += piece; });
+			detailsGeneration = registry.generation;
+		}
+		return details;
+	}
+
+	PARAMS_API void Parser::argdetails(FILE* out) const {
+		render([&](string_view piece) { fwrite(piece.data(), 1, piece.size(), out); });
+	}
+
+	PARAMS_API void Parser::argdetails(ostream& out) const {
+		render([&](string_view piece) { out.write(piece.data(), piece.size()); });
+	}
+
+	PARAMS_API size_t Parser::argdetails(char* buffer, size_t size) const {
+		size_t length = 0;
+		render([&](string_view piece) {
+			if (length+1 < size) {
+				memcpy(buffer+length, piece.data(), min(piece.size(), size-1-length));
+			}
+			length += piece.size();
+		});
+		if (size > 0) {
+			buffer[min(length, size-1)] = '\0';
+		}
+		return length;
+	}
+
+	namespace priv {
+		PARAMS_API Parser& defaultParser() {
+			static Parser parser;
+			return parser;
+		}
+	}
+#endif
+
+	// addp(...) overloads as documented in Parser, registering with the default parser
+	template<typename... Args> Option addp(Args&&... args) {
+		return priv::defaultParser().addp(forward<Args>(args)...);
+	}
+
+	// members of a config struct, see Parser::addFields
+	template<typename S, typename... M> void addFields(S& target, const Field<S,M>&... fields) {
+		priv::defaultParser().addFields(target, fields...);
+	}
+
+	inline void argparse(char** argv) {
+		priv::defaultParser().argparse(argv);
+	}
+
+	// through a cache file of the parsed values, see Parser::argparse
+	inline bool argparse(char** argv, const char* cachePath) {
+		return priv::defaultParser().argparse(argv, cachePath);
+	}
+
+	// config file, environment and argv at once, see Sources
+	inline void argparse(const Sources& sources) {
+		priv::defaultParser().argparse(sources);
+	}
+
+	// returns the failure instead of exiting, see Parser::tryparse
+	inline Error tryparse(char** argv) {
+		return priv::defaultParser().tryparse(argv);
+	}
+
+	inline Error tryparse(const Sources& sources) {
+		return priv::defaultParser().tryparse(sources);
+	}
+
+	inline const string& errordetails() {
+		return priv::defaultParser().errordetails();
+	}
+
+	// compiles the options registered so far into a Schema for batch parsing
+	inline Schema compile() {
+		return priv::defaultParser().compile();
+	}
+
+	inline const string& argdetails() {
+		return priv::defaultParser().argdetails();
+	}
+
+	inline void argdetails(FILE* out) {
+		priv::defaultParser().argdetails(out);
+	}
+
+	inline void argdetails(ostream& out) {
+		priv::defaultParser().argdetails(out);
+	}
+
+	inline size_t argdetails(char* buffer, size_t size) {
+		return priv::defaultParser().argdetails(buffer, size);
+	}
+
+	// of the last argparse, see PARAMS_STATS
+	inline const Stats& stats() {
+		return priv::defaultParser().stats();
+	}
+
+	// accept unambiguous prefixes of option names, see Parser::allowPrefixes
+	inline void allowPrefixes(bool allowed=true) {
+		priv::defaultParser().allowPrefixes(allowed);
+	}
+
+	// the options and values of the default parser in shared memory, see View
+	inline View publish() {
+		return priv::defaultParser().publish();
+	}
+
+	// a subcommand of the default parser, see Parser::command
+	inline void command(string name, string helpPhrase, function<void(Parser&)> setup) {
+		priv::defaultParser().command(move(name), move(helpPhrase), move(setup));
+	}
+
+	inline string_view activeCommand() {
+		return priv::defaultParser().activeCommand();
+	}
+
+	// Forgets all registered options and releases their storage at once.
+	inline void reset() {
+		priv::defaultParser().reset();
+	}
+}